@@ -0,0 +1,51 @@
+#version 450 core
+layout(location = 0) out vec4 FragColor;
+
+// Same mode switch as raymarch.frag, injected by Raymarcher
+#define MODE_STEPS   0
+#define MODE_NORMALS 1
+#define MODE_SHADED  2
+#ifndef MODE
+#define MODE MODE_SHADED
+#endif
+
+// G-buffer written by the march pass, same pixel grid as this pass
+uniform sampler2D  u_gPosition;  // xyz = hit position, w = t (-1 = miss)
+uniform sampler2D  u_gNormal;    // xyz = normal, w = steps / MAX_STEPS
+uniform usampler2D u_gID;        // primitive id, 0 = base
+
+#if MODE == MODE_STEPS
+// 0 → blue, 0.5 → green, 1 → red
+vec3 heat(float x) {
+    x = clamp(x, 0.0, 1.0);
+    return clamp(vec3(2.0*x - 0.5, 1.0 - abs(2.0*x - 1.0), 1.5 - 2.0*x), 0.0, 1.0);
+}
+#endif
+
+// Gentle per-object tint so spawned tori read apart from the base
+vec3 tint(uint id) {
+    if(id == 0u) return vec3(1.0);
+    uint h = id * 2654435761u;
+    vec3 c = vec3(h & 0xFFu, (h >> 8) & 0xFFu, (h >> 16) & 0xFFu) / 255.0;
+    return mix(vec3(1.0), c, 0.35);
+}
+
+void main(){
+    ivec2 px = ivec2(gl_FragCoord.xy);
+    vec4  gp = texelFetch(u_gPosition, px, 0);
+    vec4  gn = texelFetch(u_gNormal,   px, 0);
+
+#if MODE == MODE_STEPS
+    FragColor = vec4(heat(gn.w), 1.0);
+#else
+    if(gp.w < 0.0){ FragColor = vec4(1,0,1,1); return; }
+#if MODE == MODE_NORMALS
+    FragColor = vec4(gn.xyz*0.5 + 0.5, 1.0);
+#else
+    vec3 L = normalize(vec3(1,1,1));
+    float diff = max(dot(gn.xyz, L), 0.0);
+    uint id = texelFetch(u_gID, px, 0).r;
+    FragColor = vec4((vec3(0.2) + diff * vec3(0.8)) * tint(id), 1.0);
+#endif
+#endif
+}
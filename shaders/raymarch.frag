@@ -1,13 +1,57 @@
 #version 450 core
-layout(location = 0) out vec4 FragColor;
+// Pass 1 writes the tile distance to location 0; passes 0/2 fill the G-buffer
+layout(location = 0) out vec4 gPosition;   // xyz = hit position, w = t (-1 = miss)
+layout(location = 1) out vec4 gNormal;     // xyz = normal, w = steps / MAX_STEPS
+layout(location = 2) out uint gID;         // ids[] of the nearest torus, 0 = base
+
+// Variant switches, injected by Raymarcher after the #version line
+#define MODE_STEPS   0   // march step count heat map
+#define MODE_NORMALS 1   // surface normals
+#define MODE_SHADED  2   // lit surface
+#ifndef MODE
+#define MODE MODE_SHADED
+#endif
+#ifndef SPAWNS
+#define SPAWNS 1         // 0 drops the torus blend loop entirely
+#endif
+#ifndef MAX_STEPS
+#define MAX_STEPS u_maxSteps   // compile-time constant when specialized
+#endif
 
 // Uniforms
 uniform vec2  u_resolution;
 uniform int   u_maxSteps;
 uniform float u_epsilon;
+// Enhanced tracing (RaymarchConfig): over-relaxation, pixel-cone hit test,
+// bounding-sphere clip; 1 / 0 / 0 is plain sphere tracing
+uniform float u_relax;         // step = relax · dist, undone when it overshoots
+uniform float u_coneEpsilon;   // hit below max(u_epsilon, this · pixel footprint · t)
+uniform int   u_boundClip;
+uniform vec4  u_bound;         // march-space sphere holding the whole scene
+uniform int   u_countSteps;    // accumulate StepStats
+uniform int   u_pass;       // 0 = single pass, 1 = tile depth pre-pass, 2 = full-res after pre-pass
+uniform int   u_tile;       // screen pixels per pre-pass texel (edge)
+uniform sampler2D u_depthTex;  // pass 2: safe start distance per tile
+// Temporal hint: last frame's gPosition and the camera that rendered it
+uniform int   u_reproject;     // 0 = off / no valid history
+uniform float u_reprojBackoff; // start at this fraction of the reprojected t
+uniform sampler2D u_history;
+uniform vec2  u_prevResolution;
+uniform vec3  u_prevCamPos, u_prevCamForward, u_prevCamRight, u_prevCamUp;
 uniform mat4  u_objInvTransform;
 uniform vec3  u_camPos, u_camForward, u_camRight, u_camUp;
 uniform uint  u_spawnCount;
+uniform vec3  u_gridOrigin;
+uniform float u_gridCell;
+uniform ivec3 u_gridDims;
+// Brick-map cache of the base shape (see BrickMap): per coarse cell
+// r = distance bound, g = brick + 1 (0 = none); bricks of 8³ samples in an atlas
+uniform int       u_bricks;      // 0 = analytic base
+uniform sampler3D u_brickIndex;
+uniform sampler3D u_brickAtlas;
+uniform vec3      u_brickOrigin;
+uniform float     u_brickCell;
+uniform ivec3     u_brickDims;
 
 // SSBOs
 layout(std430, binding = 0) readonly buffer PosMinors {
@@ -19,6 +63,19 @@ layout(std430, binding = 1) readonly buffer IDs {
 layout(std430, binding = 2) readonly buffer Orients {
     vec4 quats[];      // x,y,z,w
 };
+// World-space grid over the tori (see TorusGrid): cell c lists the tori whose
+// bound, inflated by the blend radius, touches it
+layout(std430, binding = 3) readonly buffer CellStart {
+    uint cellStart[];  // prefix sums, one per cell + 1
+};
+layout(std430, binding = 4) readonly buffer CellItems {
+    uint cellItems[];  // torus indices, ascending per cell
+};
+// Full-res pixels marched and their steps, read back by Raymarcher
+layout(std430, binding = 5) buffer StepStats {
+    uint statPixels;
+    uint statSteps;
+};
 
 // Rotate v by the inverse of quaternion q
 vec3 rotateInv(vec4 q, vec3 v) {
@@ -33,44 +90,193 @@ float torusSDF(vec3 p, vec2 t) {
     return length(q) - t.y;
 }
 
+// Analytic base shape in object space. Raymarcher prepends the one emitted
+// from SceneSDF::baseShape() and defines BASE_SHAPE; this copy only keeps
+// the file compiling on its own.
+#ifndef BASE_SHAPE
+float baseShape(vec3 p) { return length(p) - 1.0; }
+#endif
+
+// Base shape in object space: the analytic expression, or one cached lookup
+float baseSDF(vec3 op) {
+    if(u_bricks == 0) return baseShape(op);
+
+    const int BRICK = 8;
+    vec3  hi  = u_brickOrigin + vec3(u_brickDims) * u_brickCell;
+    vec3  q   = clamp(op, u_brickOrigin, hi);
+    float ext = length(op - q);
+    vec3  g   = (q - u_brickOrigin) / u_brickCell;
+    ivec3 c   = clamp(ivec3(floor(g)), ivec3(0), u_brickDims - 1);
+    vec2  e   = texelFetch(u_brickIndex, c, 0).rg;
+
+    // Empty cell: its bound lets the ray skip it in one step
+    float d = e.r;
+    if(e.g > 0.0){
+        ivec3 ab = textureSize(u_brickAtlas, 0) / BRICK;
+        int   s  = int(e.g) - 1;
+        ivec3 a  = ivec3(s % ab.x, (s / ab.x) % ab.y, s / (ab.x * ab.y));
+        vec3  f  = clamp((g - vec3(c)) * float(BRICK - 1), 0.0, float(BRICK - 1));
+        d = texture(u_brickAtlas, (vec3(a * BRICK) + f + 0.5) / vec3(ab * BRICK)).r;
+    }
+    // Outside the box: no closer than the box, nor than the boundary sample allows
+    return ext > 0.0 ? max(ext, d - ext) : d;
+}
+
 float map(vec3 p) {
-    // Base fractal: rotating unit-sphere
+    // Base shape under the object transform
     vec3 op = (u_objInvTransform * vec4(p,1)).xyz;
-    float d = length(op) - 1.0;
+    float d = baseSDF(op);
+#if SPAWNS
+    if(u_spawnCount == 0u) return d;
+
+    const float k = 0.3;
+    vec3  g = (p - u_gridOrigin) / u_gridCell;
+    ivec3 c = ivec3(floor(g));
 
-    // Blend in each torus, rotated by its quaternion
-    for(uint i=0u; i<u_spawnCount; ++i){
+    // Outside the grid no torus is within k: bound by the distance to it
+    if(any(lessThan(c, ivec3(0))) || any(greaterThanEqual(c, u_gridDims))){
+        vec3 hi = u_gridOrigin + vec3(u_gridDims) * u_gridCell;
+        vec3 q  = max(max(u_gridOrigin - p, p - hi), 0.0);
+        return min(d, length(q) + 0.5*k);
+    }
+
+    // Blend in the tori listed for this cell, rotated by their quaternions
+    uint cell = uint(c.x + u_gridDims.x * (c.y + u_gridDims.y * c.z));
+    for(uint j=cellStart[cell]; j<cellStart[cell+1u]; ++j){
+        uint i = cellItems[j];
         vec4 pm = posMinors[i];
         vec4 q  = quats[i];
         vec3 sc = (u_objInvTransform * vec4(pm.xyz,1)).xyz;
         vec3 rel = op - sc;
         rel = rotateInv(q, rel);
         float td = torusSDF(rel, vec2(pm.w, pm.w*0.4));
-        float k = 0.3;
         float h = max(k - abs(d - td), 0.0) / k;
         d = min(d, td) - h*h*k*0.25;
     }
+
+    // Unlisted tori are at least k beyond the cell walls; their smooth-min
+    // can pull d down by at most k/4, so this stays a safe step
+    vec3 f = (g - vec3(c)) * u_gridCell;
+    vec3 w = min(f, vec3(u_gridCell) - f);
+    return min(d, min(w.x, min(w.y, w.z)) + 0.5*k);
+#else
     return d;
+#endif
 }
 
+// Tetrahedral stencil: four map() taps instead of six central differences
 vec3 estimateNormal(vec3 p) {
     const float e = 1e-4;
-    return normalize(vec3(
-        map(p+vec3( e,0,0)) - map(p-vec3( e,0,0)),
-        map(p+vec3(0, e,0)) - map(p-vec3(0, e,0)),
-        map(p+vec3(0,0, e)) - map(p-vec3(0,0, e))
-    ));
+    const vec2  k = vec2(1.0, -1.0);
+    return normalize(k.xyy * map(p + k.xyy*e) +
+                     k.yyx * map(p + k.yyx*e) +
+                     k.yxy * map(p + k.yxy*e) +
+                     k.xxx * map(p + k.xxx*e));
 }
 
-vec3 shade(vec3 p, vec3 rd) {
-    vec3 n = estimateNormal(p);
-    vec3 L = normalize(vec3(1,1,1));
-    float diff = max(dot(n,L),0.0);
-    return vec3(0.2) + diff * vec3(0.8);
+// ID of the primitive nearest to p: the closest listed torus, or 0 for the base
+uint hitID(vec3 p) {
+#if SPAWNS
+    if(u_spawnCount == 0u) return 0u;
+    ivec3 c = ivec3(floor((p - u_gridOrigin) / u_gridCell));
+    if(any(lessThan(c, ivec3(0))) || any(greaterThanEqual(c, u_gridDims))) return 0u;
+
+    vec3 op = (u_objInvTransform * vec4(p,1)).xyz;
+    float best = baseSDF(op);
+    uint  id   = 0u;
+    uint cell = uint(c.x + u_gridDims.x * (c.y + u_gridDims.y * c.z));
+    for(uint j=cellStart[cell]; j<cellStart[cell+1u]; ++j){
+        uint i = cellItems[j];
+        vec4 pm = posMinors[i];
+        vec3 sc = (u_objInvTransform * vec4(pm.xyz,1)).xyz;
+        float td = torusSDF(rotateInv(quats[i], op - sc), vec2(pm.w, pm.w*0.4));
+        if(td < best){ best = td; id = ids[i]; }
+    }
+    return id;
+#else
+    return 0u;
+#endif
+}
+
+// Last frame's hit along this ray: fetch the history at this pixel, then
+// again where the ray's point at that distance projects into the previous
+// camera. The start t is backed off from it, or 0 when the ray passes not
+// close to that hit (disocclusion, off-screen, miss).
+float reproject(vec3 ro, vec3 rd) {
+    float foot = 2.0 / u_resolution.y;   // pixel footprint per unit t
+    ivec2 px = ivec2(gl_FragCoord.xy / u_resolution * u_prevResolution);
+    float t = 0.0;
+    vec4  h;
+    for(int it=0; it<2; ++it){
+        h = texelFetch(u_history, px, 0);
+        if(h.w < 0.0) return 0.0;
+        t = dot(h.xyz - ro, rd);
+        if(t <= 0.0 || t > 100.0) return 0.0;
+        if(it == 1) break;
+
+        // Where this ray's point at t landed on last frame's screen
+        vec3 v = ro + rd*t - u_prevCamPos;
+        float z = dot(v, u_prevCamForward);
+        if(z <= 1e-4) return 0.0;
+        vec2 uv = vec2(dot(v, u_prevCamRight), dot(v, u_prevCamUp)) / z;
+        uv.x *= u_prevResolution.y / u_prevResolution.x;
+        px = ivec2((uv*0.5 + 0.5) * u_prevResolution);
+        if(any(lessThan(px, ivec2(0))) || any(greaterThanEqual(px, ivec2(u_prevResolution)))) return 0.0;
+    }
+    // The hit must lie within a few pixels of this ray
+    if(length(ro + rd*t - h.xyz) > 4.0*foot*t + u_epsilon) return 0.0;
+    return t * u_reprojBackoff;
+}
+
+// Where the ray enters the torus grid, widened by the blend radius; 1e30 if
+// it never does. The tori move and spawn between frames, so last frame's hit
+// only proves the ray empty up to here.
+float gridEntry(vec3 ro, vec3 rd) {
+#if SPAWNS
+    if(u_spawnCount == 0u) return 1e30;
+    const float k = 0.3;
+    vec3 lo = u_gridOrigin - k;
+    vec3 hi = u_gridOrigin + vec3(u_gridDims) * u_gridCell + k;
+    vec3 inv = 1.0 / mix(rd, vec3(1e-8), equal(rd, vec3(0.0)));
+    vec3 t0 = (lo - ro) * inv, t1 = (hi - ro) * inv;
+    vec3 tn = min(t0, t1), tf = max(t0, t1);
+    float tIn  = max(max(tn.x, tn.y), tn.z);
+    float tOut = min(min(tf.x, tf.y), tf.z);
+    if(tIn > tOut || tOut < 0.0) return 1e30;
+    return max(tIn, 0.0);
+#else
+    return 1e30;
+#endif
+}
+
+void countSteps(int steps) {
+    if(u_countSteps == 0) return;
+    atomicAdd(statPixels, 1u);
+    atomicAdd(statSteps, uint(steps));
+}
+
+void writeHit(vec3 ro, vec3 rd, vec3 pos, float t, int steps) {
+    gPosition = vec4(ro + rd*t, t);
+#if MODE == MODE_STEPS
+    gNormal   = vec4(0, 0, 0, float(steps) / float(MAX_STEPS));
+#else
+    gNormal   = vec4(estimateNormal(pos), float(steps) / float(MAX_STEPS));
+#endif
+    gID       = hitID(pos);
+    countSteps(steps);
+}
+
+void writeMiss(int steps) {
+    gPosition = vec4(0,0,0,-1);
+    gNormal   = vec4(0, 0, 0, float(steps) / float(MAX_STEPS));
+    gID       = 0u;
+    countSteps(steps);
 }
 
 void main(){
-    vec2 uv = (gl_FragCoord.xy / u_resolution)*2.0 - 1.0;
+    // Pass 1 covers a u_tile×u_tile block of screen pixels per fragment
+    vec2 pix = (u_pass == 1) ? gl_FragCoord.xy * float(u_tile) : gl_FragCoord.xy;
+    vec2 uv = (pix / u_resolution)*2.0 - 1.0;
     uv.x *= u_resolution.x / u_resolution.y;
     vec3 rd = normalize(uv.x*u_camRight + uv.y*u_camUp + u_camForward);
     vec3 ro = u_camPos;
@@ -80,16 +286,74 @@ void main(){
     vec3 rld = normalize((u_objInvTransform * vec4(rd,0)).xyz);
 
     float t = 0.0;
-    for(int i=0;i<u_maxSteps;++i){
-        vec3 pos = rlo + rld*t;
-        float dist = map(pos);
-        if(dist < u_epsilon){
-            vec3 worldPos = ro + rd*t;
-            FragColor = vec4(shade(worldPos,rd),1.0);
-            return;
+
+    if(u_pass == 1){
+        // Cone march: every ray of the tile lies within cone*t of the center
+        // ray, so the free sphere only clears them for dist - cone*t. Stop
+        // once that runs out; the t reached is safe for the whole tile.
+        float cone = 1.5 * float(u_tile) / u_resolution.y;
+        for(int i=0;i<MAX_STEPS;++i){
+            float adv = map(rlo + rld*t) - cone*t;
+            if(adv < u_epsilon) break;
+            t += adv;
+            if(t > 100.0) break;
         }
-        t += dist;
-        if(t > 100.0) break;
+        gPosition = vec4(t);
+        return;
     }
-    FragColor = vec4(1,0,1,1);
-}
+    if(u_pass == 2){
+        t = texelFetch(u_depthTex, ivec2(gl_FragCoord.xy) / u_tile, 0).r;
+        if(t > 100.0){ writeMiss(0); return; }
+    }
+    if(u_reproject != 0){
+        // Only a hint: a start point already inside the surface falls back,
+        // and none lies past the torus grid's near side
+        float th = min(reproject(ro, rd), gridEntry(rlo, rld));
+        if(th > t && map(rlo + rld*th) > 0.0) t = th;
+    }
+
+    // Scene bound: a ray that misses it is done, the rest march only inside
+    float tMax = 100.0;
+    if(u_boundClip != 0){
+        vec3  oc = rlo - u_bound.xyz;
+        float b  = dot(oc, rld);
+        float h  = b*b - dot(oc, oc) + u_bound.w*u_bound.w;
+        if(h < 0.0){ writeMiss(0); return; }
+        h = sqrt(h);
+        t    = max(t, -b - h);
+        tMax = min(tMax, -b + h);
+        if(t > tMax){ writeMiss(0); return; }
+    }
+
+    // Over-relaxed sphere tracing: step relax·d while consecutive free
+    // spheres overlap; when they stop overlapping the step overshot, so it is
+    // taken back and the march continues plain. The hit threshold grows with
+    // the pixel footprint, and the ray point with the smallest error relative
+    // to it is kept in case the step budget runs out first.
+    float foot = u_coneEpsilon * 2.0 / u_resolution.y;
+    float omega = u_relax;
+    float prevR = 0.0, stepLen = 0.0;
+    float candT = t, candErr = 1e30;
+    int i = 0;
+    for(; i<MAX_STEPS; ++i){
+        float dist = map(rlo + rld*t);
+        float rad  = abs(dist);
+        bool  fail = omega > 1.0 && rad + prevR < stepLen;
+        if(fail){
+            stepLen -= omega * stepLen;
+            omega = 1.0;
+        } else {
+            stepLen = dist * omega;
+            float thr = max(u_epsilon, foot * t);
+            if(dist < thr){ writeHit(ro, rd, rlo + rld*t, t, i); return; }
+            if(rad / thr < candErr){ candErr = rad / thr; candT = t; }
+        }
+        prevR = rad;
+        t += stepLen;
+        if(t > tMax) break;
+    }
+    // Out of steps short of the far bound: a near-miss within two cone
+    // widths counts as the hit rather than a hole
+    if(i == MAX_STEPS && foot > 0.0 && candErr < 2.0){ writeHit(ro, rd, rlo + rld*candT, candT, i); return; }
+    writeMiss(i);
+}
\ No newline at end of file
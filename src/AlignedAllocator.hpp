@@ -0,0 +1,31 @@
+// AlignedAllocator.hpp
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+// std::vector allocator handing out `Align`-byte aligned blocks (C++17 aligned new)
+template <class T, size_t Align>
+struct AlignedAllocator {
+    using value_type = T;
+    template <class U> struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() = default;
+    template <class U> AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+};
+
+template <class T, class U, size_t A>
+bool operator==(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return true; }
+template <class T, class U, size_t A>
+bool operator!=(const AlignedAllocator<T, A>&, const AlignedAllocator<U, A>&) { return false; }
+
+// 64-byte aligned float array, the storage type of the SoA physics data
+using FloatArray = std::vector<float, AlignedAllocator<float, 64>>;
@@ -0,0 +1,124 @@
+// BrickMap.cpp
+#include "BrickMap.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+bool BrickMap::bake(const BrickMapConfig& cfg, const std::function<float(const glm::vec3&)>& sdf) {
+    PROFILE_ZONE("brick map bake");
+    clear();
+    const glm::vec3 size = cfg.hi - cfg.lo;
+    if (!(cfg.voxel > 0.0f) || !(size.x > 0.0f && size.y > 0.0f && size.z > 0.0f)) {
+        std::cerr << "Brick map: empty bounds or non-positive voxel size\n";
+        return false;
+    }
+
+    origin_ = cfg.lo;
+    cell_   = cfg.voxel * float(BRICK - 1);
+    dims_   = glm::ivec3(glm::ceil(size / cell_));
+    const size_t cells = size_t(dims_.x) * dims_.y * dims_.z;
+    coarse_.assign(cells, 0.0f);
+    index_ .assign(cells, 0u);
+
+    // --- Classify cells by the distance at their centre ---
+    const float halfDiag = 0.5f * cell_ * std::sqrt(3.0f);
+    size_t c = 0;
+    for (int z = 0; z < dims_.z; ++z)
+    for (int y = 0; y < dims_.y; ++y)
+    for (int x = 0; x < dims_.x; ++x, ++c) {
+        const glm::vec3 lo = origin_ + glm::vec3(x, y, z) * cell_;
+        const float d = sdf(lo + 0.5f * cell_);
+        if (std::fabs(d) >= halfDiag + cfg.band) {
+            // Lipschitz bound: nothing in the cell is closer than this
+            coarse_[c] = d > 0.0f ? d - halfDiag : d + halfDiag;
+            continue;
+        }
+
+        // --- Narrow band: bake a brick, corners on the cell's faces ---
+        index_[c] = uint32_t(brickCount() + 1);
+        const size_t base = bricks_.size();
+        bricks_.resize(base + BRICK_SAMPLES);
+        float* b = bricks_.data() + base;
+        for (int k = 0; k < BRICK; ++k)
+        for (int j = 0; j < BRICK; ++j)
+        for (int i = 0; i < BRICK; ++i)
+            *b++ = sdf(lo + glm::vec3(i, j, k) * cfg.voxel);
+        coarse_[c] = d;
+    }
+    return true;
+}
+
+void BrickMap::clear() {
+    dims_ = glm::ivec3(0);
+    cell_ = 0.0f;
+    coarse_.clear();
+    index_.clear();
+    bricks_.clear();
+}
+
+size_t BrickMap::bytes() const {
+    return coarse_.size() * sizeof(float) + index_.size() * sizeof(uint32_t) + bricks_.size() * sizeof(float);
+}
+
+float BrickMap::sampleCell(const glm::vec3& p, glm::vec3& gradient) const {
+    const glm::vec3 g = (p - origin_) / cell_;
+    const glm::ivec3 c = glm::clamp(glm::ivec3(glm::floor(g)), glm::ivec3(0), dims_ - 1);
+    const size_t cell = size_t(c.x) + size_t(dims_.x) * (size_t(c.y) + size_t(dims_.y) * size_t(c.z));
+    const uint32_t slot = index_[cell];
+    if (!slot) { gradient = glm::vec3(0.0f); return coarse_[cell]; }
+
+    // --- Trilinear over the 8 samples around p, analytic gradient ---
+    const glm::vec3 f = glm::clamp((g - glm::vec3(c)) * float(BRICK - 1), 0.0f, float(BRICK - 1));
+    const glm::ivec3 i0 = glm::min(glm::ivec3(f), glm::ivec3(BRICK - 2));
+    const glm::vec3 t = f - glm::vec3(i0);
+    const float* b = brick(slot - 1) + (i0.z * BRICK + i0.y) * BRICK + i0.x;
+    const float c000 = b[0],                 c100 = b[1];
+    const float c010 = b[BRICK],             c110 = b[BRICK + 1];
+    const float c001 = b[BRICK * BRICK],     c101 = b[BRICK * BRICK + 1];
+    const float c011 = b[BRICK * BRICK + BRICK], c111 = b[BRICK * BRICK + BRICK + 1];
+
+    const float x00 = c000 + t.x * (c100 - c000), x10 = c010 + t.x * (c110 - c010);
+    const float x01 = c001 + t.x * (c101 - c001), x11 = c011 + t.x * (c111 - c011);
+    const float y0  = x00 + t.y * (x10 - x00),    y1  = x01 + t.y * (x11 - x01);
+
+    const float invVoxel = float(BRICK - 1) / cell_;
+    const float dx0 = (c100 - c000) + t.y * ((c110 - c010) - (c100 - c000));
+    const float dx1 = (c101 - c001) + t.y * ((c111 - c011) - (c101 - c001));
+    gradient.x = (dx0 + t.z * (dx1 - dx0)) * invVoxel;
+    gradient.y = ((x10 - x00) + t.z * ((x11 - x01) - (x10 - x00))) * invVoxel;
+    gradient.z = (y1 - y0) * invVoxel;
+    return y0 + t.z * (y1 - y0);
+}
+
+float BrickMap::sample(const glm::vec3& p, glm::vec3* gradient) const {
+    glm::vec3 grad(0.0f);
+    float d;
+    if (empty()) {
+        d = 0.0f;
+    } else {
+        // Outside the box the surface is at least as far as the box, and no
+        // closer than the boundary sample minus the way there
+        const glm::vec3 hi = origin_ + glm::vec3(dims_) * cell_;
+        const glm::vec3 q  = glm::clamp(p, origin_, hi);
+        const float out    = glm::length(p - q);
+        d = sampleCell(q, grad);
+        if (out > 0.0f) {
+            if (d - out < out) { d = out; grad = (p - q) / out; }
+            else               { d -= out; }
+        }
+    }
+    if (gradient) *gradient = grad;
+    return d;
+}
+
+void BrickMap::sample(const float* px, const float* py, const float* pz, size_t count,
+                      float* dist, float* gx, float* gy, float* gz) const {
+    const bool grad = gx && gy && gz;
+    for (size_t i = 0; i < count; ++i) {
+        glm::vec3 g;
+        dist[i] = sample(glm::vec3(px[i], py[i], pz[i]), &g);
+        if (!grad) continue;
+        gx[i] = g.x; gy[i] = g.y; gz[i] = g.z;
+    }
+}
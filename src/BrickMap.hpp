@@ -0,0 +1,61 @@
+// BrickMap.hpp
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct BrickMapConfig {
+    glm::vec3 lo{-1.5f}, hi{1.5f};   // object-space bounds; must contain the surface
+    float     voxel = 1.0f / 32.0f;  // sample spacing inside bricks
+    float     band  = 0.25f;         // bricks cover everything closer than this to the
+                                     // surface; keep it above the largest body radius
+};
+
+// Sparse distance-field cache of a static SDF. Space is cut into coarse
+// cells of (BRICK-1) voxels; cells within the narrow band own a brick of
+// BRICK³ samples (corners shared with the neighbours, so trilinear lookups
+// are seamless), every other cell stores a conservative distance bound that
+// lets a ray or query skip the whole cell. Outside the bounds the distance
+// to the box is used. All coordinates are in the SDF's object space.
+class BrickMap {
+public:
+    static constexpr int BRICK = 8;   // samples per brick edge
+
+    // Evaluate `sdf` at every narrow-band sample; false if the bounds are
+    // empty or the voxel size is not positive
+    bool bake(const BrickMapConfig& cfg, const std::function<float(const glm::vec3&)>& sdf);
+    void clear();
+    bool empty() const { return dims_.x == 0; }
+
+    // Trilinear distance and its gradient at `count` object-space points;
+    // the gradient pointers may be null. Cells without a brick report their
+    // bound and a zero gradient.
+    void sample(const float* px, const float* py, const float* pz, size_t count,
+                float* dist, float* gx, float* gy, float* gz) const;
+    float sample(const glm::vec3& p, glm::vec3* gradient = nullptr) const;
+
+    // Layout, as uploaded by Raymarcher::setBrickMap
+    const glm::vec3&  origin()   const { return origin_; }
+    float             cellSize() const { return cell_; }
+    const glm::ivec3& dims()     const { return dims_; }
+    size_t            brickCount() const { return bricks_.size() / BRICK_SAMPLES; }
+    const float*      brick(size_t i) const { return bricks_.data() + i * BRICK_SAMPLES; }   // x fastest
+    const std::vector<float>&    coarse() const { return coarse_; }   // per cell, bound if no brick
+    const std::vector<uint32_t>& index()  const { return index_; }    // per cell, brick + 1 (0 = none)
+    size_t            bytes() const;
+
+private:
+    static constexpr size_t BRICK_SAMPLES = size_t(BRICK) * BRICK * BRICK;
+
+    float sampleCell(const glm::vec3& p, glm::vec3& gradient) const;
+
+    glm::vec3             origin_{0.0f};
+    float                 cell_ = 0.0f;
+    glm::ivec3            dims_{0};
+    std::vector<float>    coarse_;
+    std::vector<uint32_t> index_;
+    std::vector<float>    bricks_;
+};
@@ -0,0 +1,79 @@
+// Broadphase.cpp
+#include "Broadphase.hpp"
+#include <algorithm>
+#include <cmath>
+
+uint32_t Broadphase::bucketOf(const glm::ivec3& c) const {
+    uint32_t h = (uint32_t(c.x) * 73856093u) ^ (uint32_t(c.y) * 19349663u) ^ (uint32_t(c.z) * 83492791u);
+    return h & mask_;
+}
+
+ArenaVector<BodyPair> Broadphase::findPairs(const float* x, const float* y, const float* z,
+                                            const float* radii, size_t count, FrameArena& frame)
+{
+    uint32_t n = (uint32_t)count;
+    ArenaVector<BodyPair> pairs(frame);
+    // Last call's count plus slack; growing copies would strand arena bytes
+    pairs.reserve(stats_.pairTests + stats_.pairTests / 8);
+    stats_ = BroadphaseStats{};
+    stats_.bodies       = n;
+    stats_.allPairTests = size_t(n) * (n > 0 ? n - 1 : 0) / 2;
+    if (n < 2) return pairs;
+
+    float maxR = 0.0f;
+    for (uint32_t i = 0; i < n; ++i) maxR = std::max(maxR, radii[i]);
+    if (maxR <= 0.0f) return pairs;
+    const float invCell = 1.0f / (2.0f * maxR);
+
+    // --- Bucket table: power of two, ~2 buckets per body ---
+    uint32_t buckets = 1;
+    while (buckets < 2 * n) buckets <<= 1;
+    mask_ = buckets - 1;
+    stats_.buckets = buckets;
+
+    // --- Counting sort of bodies by bucket ---
+    glm::ivec3* cells       = frame.allocate<glm::ivec3>(n);          // grid cell per body
+    uint32_t*   sorted      = frame.allocate<uint32_t>(n);            // body indices grouped by bucket
+    uint32_t*   bucketStart = frame.allocate<uint32_t>(buckets + 1);  // prefix sums
+    std::fill(bucketStart, bucketStart + buckets + 1, 0u);
+    const float lim = float(1 << 30);
+    for (uint32_t i = 0; i < n; ++i) {
+        glm::vec3 g = glm::clamp(glm::floor(glm::vec3(x[i], y[i], z[i]) * invCell), glm::vec3(-lim), glm::vec3(lim));
+        cells[i] = glm::ivec3(g);
+        ++bucketStart[bucketOf(cells[i]) + 1];
+    }
+    for (uint32_t b = 0; b < buckets; ++b) bucketStart[b + 1] += bucketStart[b];
+    for (uint32_t i = 0; i < n; ++i) {
+        // bucketStart[b] doubles as the fill cursor, then gets shifted back
+        sorted[bucketStart[bucketOf(cells[i])]++] = i;
+    }
+    for (uint32_t b = buckets; b > 0; --b) bucketStart[b] = bucketStart[b - 1];
+    bucketStart[0] = 0;
+
+    // --- Gather pairs from the 27 neighbouring cells ---
+    // Compared against c ± 1, never subtracted: two clamped cells can be 2^31 apart
+    auto apart = [](int a, int c) { return a < c - 1 || a > c + 1; };
+    for (uint32_t i = 0; i < n; ++i) {
+        const glm::ivec3 ci = cells[i];
+        uint32_t visited[27];
+        int nVisited = 0;
+        for (int dz = -1; dz <= 1; ++dz)
+        for (int dy = -1; dy <= 1; ++dy)
+        for (int dx = -1; dx <= 1; ++dx) {
+            uint32_t b = bucketOf(ci + glm::ivec3(dx, dy, dz));
+            // Distinct cells may hash to one bucket; scan each bucket once
+            if (std::find(visited, visited + nVisited, b) != visited + nVisited) continue;
+            visited[nVisited++] = b;
+
+            for (uint32_t k = bucketStart[b]; k < bucketStart[b + 1]; ++k) {
+                uint32_t j = sorted[k];
+                if (j <= i) continue;
+                const glm::ivec3 cj = cells[j];
+                if (apart(cj.x, ci.x) || apart(cj.y, ci.y) || apart(cj.z, ci.z)) continue;
+                pairs.push_back(BodyPair{ i, j });
+            }
+        }
+    }
+    stats_.pairTests = pairs.size();
+    return pairs;
+}
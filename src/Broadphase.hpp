@@ -0,0 +1,38 @@
+// Broadphase.hpp
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "FrameArena.hpp"
+
+struct BodyPair {
+    uint32_t a, b;   // a < b
+};
+
+struct BroadphaseStats {
+    size_t bodies       = 0;
+    size_t buckets      = 0;
+    size_t pairTests    = 0;  // candidate pairs handed to the narrow phase
+    size_t allPairTests = 0;  // what the O(n²) loop would have tested
+};
+
+// Uniform-grid broadphase for sphere–sphere contacts. Cells are 2 * max radius
+// wide, so any overlapping pair sits in neighbouring cells. Cells are hashed
+// into a power-of-two bucket table and bodies are counting-sorted by bucket;
+// the grid and the pairs are frame scratch.
+class Broadphase {
+public:
+    // Rebuild the grid and return candidate pairs, ordered by `a`. Everything
+    // lives in `frame` and is valid until its next reset().
+    ArenaVector<BodyPair> findPairs(const float* x, const float* y, const float* z,
+                                    const float* radii, size_t count, FrameArena& frame);
+
+    const BroadphaseStats& stats() const { return stats_; }
+
+private:
+    uint32_t bucketOf(const glm::ivec3& c) const;
+
+    BroadphaseStats         stats_;
+    uint32_t                mask_ = 0;
+};
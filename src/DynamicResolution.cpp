@@ -0,0 +1,55 @@
+// DynamicResolution.cpp
+#include "DynamicResolution.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Ignore corrections smaller than this; keeps the scale from jittering
+static constexpr float SCALE_DEADBAND = 0.01f;
+
+DynamicResolution::~DynamicResolution() {
+    if (queries_[0]) glDeleteQueries(QUERIES, queries_);
+}
+
+void DynamicResolution::begin() {
+    if (!queries_[0]) glGenQueries(QUERIES, queries_);
+    harvest();
+
+    // All queries still in flight: leave this frame untimed rather than wait
+    timing_ = !pending_[next_];
+    if (!timing_) return;
+    issuedScale_[next_] = scale_;
+    glBeginQuery(GL_TIME_ELAPSED, queries_[next_]);
+}
+
+void DynamicResolution::end() {
+    if (!timing_) return;
+    glEndQuery(GL_TIME_ELAPSED);
+    pending_[next_] = true;
+    next_   = (next_ + 1) % QUERIES;
+    timing_ = false;
+}
+
+void DynamicResolution::harvest() {
+    // Oldest first: slots after next_ were issued earliest
+    for (int k = 0; k < QUERIES; ++k) {
+        int q = (next_ + k) % QUERIES;
+        if (!pending_[q]) continue;
+        GLint ready = 0;
+        glGetQueryObjectiv(queries_[q], GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready) break;
+
+        GLuint64 ns = 0;
+        glGetQueryObjectui64v(queries_[q], GL_QUERY_RESULT, &ns);
+        pending_[q] = false;
+        gpuMs_ = float(double(ns) * 1e-6);
+
+        if (cfg_.budgetMs <= 0.0f) { scale_ = cfg_.maxScale; continue; }
+        if (gpuMs_ <= 0.0f) continue;
+        // Pixel count ∝ scale², so the scale that meets the budget is:
+        float target = issuedScale_[q] * std::sqrt(cfg_.budgetMs / gpuMs_);
+        target = std::min(std::max(target, cfg_.minScale), cfg_.maxScale);
+        float next = scale_ + cfg_.gain * (target - scale_);
+        if (std::fabs(next - scale_) >= SCALE_DEADBAND || target == cfg_.minScale || target == cfg_.maxScale)
+            scale_ = std::min(std::max(next, cfg_.minScale), cfg_.maxScale);
+    }
+}
@@ -0,0 +1,48 @@
+// DynamicResolution.hpp
+#pragma once
+
+#include <glad/glad.h>
+
+struct DynamicResolutionConfig {
+    float budgetMs = 12.0f;   // GPU time target per frame; <= 0 pins maxScale
+    float minScale = 0.5f;    // per-axis render scale bounds
+    float maxScale = 1.0f;
+    float gain     = 0.25f;   // fraction of the correction applied per sample
+};
+
+// Picks the per-axis render scale from GPU frame times. Frames are timed with
+// a ring of GL_TIME_ELAPSED queries that are read back only once available,
+// so the controller never stalls the pipeline; it lags a few frames instead.
+// Cost is taken to scale with pixel count, i.e. with scale².
+class DynamicResolution {
+public:
+    DynamicResolution() = default;
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution&) = delete;
+    DynamicResolution& operator=(const DynamicResolution&) = delete;
+
+    // Bracket the GPU work of one frame
+    void begin();
+    void end();
+
+    float scale() const { return scale_; }
+    float gpuMs() const { return gpuMs_; }    // latest measured frame
+
+    DynamicResolutionConfig&       config()       { return cfg_; }
+    const DynamicResolutionConfig& config() const { return cfg_; }
+
+private:
+    static constexpr int QUERIES = 4;
+
+    void harvest();
+
+    DynamicResolutionConfig cfg_;
+    GLuint queries_[QUERIES] = {};
+    float  issuedScale_[QUERIES] = {};   // scale the query's frame ran at
+    bool   pending_[QUERIES] = {};
+    int    next_   = 0;
+    bool   timing_ = false;              // a query is open
+    float  scale_  = 1.0f;
+    float  gpuMs_  = 0.0f;
+};
@@ -0,0 +1,65 @@
+// FrameArena.cpp
+#include "FrameArena.hpp"
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+FrameArena::~FrameArena() {
+    release();
+}
+
+void* FrameArena::allocate(size_t bytes, size_t align) {
+    assert(align && (align & (align - 1)) == 0 && align <= BLOCK_ALIGN);
+    for (;;) {
+        if (current_ < blocks_.size()) {
+            const Block& b = blocks_[current_];
+            // Blocks are BLOCK_ALIGN aligned, so aligning the offset aligns the address
+            const size_t at = (offset_ + align - 1) & ~(align - 1);
+            if (at <= b.size && bytes <= b.size - at) {
+                used_     += at + bytes - offset_;
+                offset_    = at + bytes;
+                highWater_ = std::max(highWater_, used_);
+                return b.data + at;
+            }
+            if (current_ + 1 < blocks_.size()) {
+                ++current_;
+                offset_ = 0;
+                continue;
+            }
+        }
+        // --- Out of blocks: grow geometrically, at least enough for this one ---
+        addBlock(std::max({ blockBytes_, capacity(), bytes }));
+        current_ = blocks_.size() - 1;
+        offset_  = 0;
+    }
+}
+
+void FrameArena::reset() {
+    if (blocks_.size() > 1) {
+        // Last frame spilled: one block with a quarter of headroom over the
+        // high-water mark, rounded to pages
+        const size_t want = (highWater_ + highWater_ / 4 + 4095) & ~size_t(4095);
+        release();
+        addBlock(std::max(want, blockBytes_));
+    }
+    current_ = 0;
+    offset_  = 0;
+    used_    = 0;
+}
+
+size_t FrameArena::capacity() const {
+    size_t total = 0;
+    for (const Block& b : blocks_) total += b.size;
+    return total;
+}
+
+void FrameArena::addBlock(size_t bytes) {
+    auto* data = static_cast<std::byte*>(::operator new(bytes, std::align_val_t(BLOCK_ALIGN)));
+    blocks_.push_back(Block{ data, bytes });
+    ++heapBlocks_;
+}
+
+void FrameArena::release() {
+    for (const Block& b : blocks_) ::operator delete(b.data, std::align_val_t(BLOCK_ALIGN));
+    blocks_.clear();
+}
@@ -0,0 +1,75 @@
+// FrameArena.hpp
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Bump allocator for scratch that lives for one frame. allocate() carves
+// bytes off the current block and opens another one when it runs out;
+// nothing is freed on its own. reset() drops everything at once and, if the
+// frame spilled over several blocks, folds them into a single block sized
+// from the high-water mark, so a steady workload stops touching the heap
+// after its first frames. Not thread-safe: one owner allocates and resets.
+class FrameArena {
+public:
+    static constexpr size_t BLOCK_ALIGN = 64;   // blocks start on a cache line
+
+    explicit FrameArena(size_t blockBytes = 64 * 1024) : blockBytes_(blockBytes) {}
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    // `align` is a power of two no larger than BLOCK_ALIGN
+    void* allocate(size_t bytes, size_t align);
+    template <class T> T* allocate(size_t n) {
+        return static_cast<T*>(allocate(n * sizeof(T), alignof(T)));
+    }
+
+    // Start the next frame; every pointer handed out so far dies here
+    void reset();
+
+    size_t used()       const { return used_; }        // this frame, alignment padding included
+    size_t highWater()  const { return highWater_; }   // largest used() of any frame
+    size_t capacity()   const;                         // bytes held in blocks
+    size_t heapBlocks() const { return heapBlocks_; }  // blocks ever taken from the heap
+
+private:
+    struct Block {
+        std::byte* data;
+        size_t     size;
+    };
+    void addBlock(size_t bytes);
+    void release();
+
+    std::vector<Block> blocks_;
+    size_t current_    = 0;   // block being carved
+    size_t offset_     = 0;   // first free byte in it
+    size_t used_       = 0;
+    size_t highWater_  = 0;
+    size_t heapBlocks_ = 0;
+    size_t blockBytes_;
+};
+
+// STL adaptor: containers draw from a FrameArena and never free; their
+// memory goes back with the arena's reset(), so they must not outlive it
+template <class T>
+struct ArenaAllocator {
+    using value_type = T;
+
+    FrameArena* arena;
+
+    ArenaAllocator(FrameArena& a) : arena(&a) {}
+    template <class U> ArenaAllocator(const ArenaAllocator<U>& o) : arena(o.arena) {}
+
+    T*   allocate(size_t n)  { return arena->allocate<T>(n); }
+    void deallocate(T*, size_t) {}
+};
+
+template <class T, class U>
+bool operator==(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena == b.arena; }
+template <class T, class U>
+bool operator!=(const ArenaAllocator<T>& a, const ArenaAllocator<U>& b) { return a.arena != b.arena; }
+
+template <class T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,74 @@
+// FrameClock.cpp
+#include "FrameClock.hpp"
+#include <algorithm>
+#include <thread>
+
+size_t FrameHistogram::bucketOf(float ms) {
+    if (!(ms > 0.0f)) return 0;
+    return std::min(size_t(ms / BUCKET_MS), BUCKETS - 1);
+}
+
+void FrameHistogram::add(float ms) {
+    if (count_ == WINDOW) {
+        // Evict the sample this one overwrites
+        const float old = ring_[next_];
+        --buckets_[bucketOf(old)];
+        sumMs_ -= old;
+    } else {
+        ++count_;
+    }
+    ring_[next_] = ms;
+    next_ = (next_ + 1) % WINDOW;
+    ++buckets_[bucketOf(ms)];
+    sumMs_ += ms;
+}
+
+void FrameHistogram::clear() {
+    buckets_.fill(0);
+    next_ = count_ = 0;
+    sumMs_ = 0.0;
+}
+
+float FrameHistogram::maxMs() const {
+    float m = 0.0f;
+    for (size_t i = 0; i < count_; ++i) m = std::max(m, ring_[i]);
+    return m;
+}
+
+float FrameHistogram::percentileMs(float p) const {
+    if (!count_) return 0.0f;
+    const size_t rank = std::min(count_, size_t(std::max(1.0f, p * float(count_) + 0.5f)));
+    size_t seen = 0;
+    for (size_t b = 0; b < BUCKETS - 1; ++b) {
+        seen += buckets_[b];
+        if (seen >= rank) return float(b + 1) * BUCKET_MS;
+    }
+    return maxMs();   // overflow bucket: report the real worst frame
+}
+
+void FrameClock::setTargetFps(float fps) {
+    targetFps_ = fps > 0.0f ? fps : 0.0f;
+    period_ = targetFps_ > 0.0f
+        ? std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(1.0 / targetFps_))
+        : clock::duration(0);
+}
+
+void FrameClock::waitUntil(clock::time_point deadline) const {
+    // --- Coarse sleep, leaving SPIN_US for scheduler wake-up jitter ---
+    const auto margin = std::chrono::microseconds(SPIN_US);
+    auto now = clock::now();
+    if (deadline - now > margin) std::this_thread::sleep_for(deadline - now - margin);
+
+    // --- Spin the tail ---
+    while (clock::now() < deadline) std::this_thread::yield();
+}
+
+float FrameClock::tick() {
+    if (period_.count() > 0) waitUntil(last_ + period_);
+
+    const auto now = clock::now();
+    delta_ = std::chrono::duration<float>(now - last_).count();
+    last_  = now;
+    if (frames_++) histogram_.add(delta_ * 1000.0f);   // the first tick measures startup, not a frame
+    return delta_;
+}
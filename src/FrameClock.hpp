@@ -0,0 +1,69 @@
+// FrameClock.hpp
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Frame-time distribution over the last WINDOW frames, bucketed at
+// BUCKET_MS so percentiles are a bucket walk instead of a sort.
+class FrameHistogram {
+public:
+    static constexpr size_t WINDOW     = 1024;
+    static constexpr size_t BUCKETS    = 400;    // 0 .. 100 ms, last bucket is overflow
+    static constexpr float  BUCKET_MS  = 0.25f;
+
+    void   add(float ms);
+    void   clear();
+
+    size_t samples() const { return count_; }
+    float  avgMs()   const { return count_ ? float(sumMs_ / double(count_)) : 0.0f; }
+    float  maxMs()   const;
+    // Upper edge of the bucket holding the p-th percentile (p in [0,1])
+    float  percentileMs(float p) const;
+
+private:
+    static size_t bucketOf(float ms);
+
+    std::array<float, WINDOW>     ring_{};
+    std::array<uint32_t, BUCKETS> buckets_{};
+    size_t next_  = 0, count_ = 0;
+    double sumMs_ = 0.0;
+};
+
+// Main-thread frame clock: tick() once per frame, at the frame boundary.
+// Optionally paces frames to a target rate by sleeping most of the
+// remaining time and spinning the last SPIN_US for precision.
+class FrameClock {
+public:
+    using clock = std::chrono::steady_clock;
+
+    static constexpr int64_t SPIN_US = 1500;   // sleep granularity margin
+
+    FrameClock() : start_(clock::now()), last_(start_) {}
+
+    // Waits for the limiter if one is set, then returns seconds since the
+    // previous tick
+    float tick();
+
+    // 0 disables the limiter
+    void  setTargetFps(float fps);
+    float targetFps() const { return targetFps_; }
+
+    float deltaTime() const { return delta_; }
+    float totalTime() const { return std::chrono::duration<float>(last_ - start_).count(); }
+    uint64_t frames() const { return frames_; }
+
+    const FrameHistogram& histogram() const { return histogram_; }
+
+private:
+    void waitUntil(clock::time_point deadline) const;
+
+    clock::time_point start_, last_;
+    clock::duration   period_{0};
+    float             targetFps_ = 0.0f;
+    float             delta_     = 0.0f;
+    uint64_t          frames_    = 0;
+    FrameHistogram    histogram_;
+};
@@ -0,0 +1,68 @@
+// GpuProfiler.cpp
+#include "GpuProfiler.hpp"
+#include <algorithm>
+
+// Frames between re-measuring the CPU/GPU clock offset
+static constexpr unsigned CALIBRATE_INTERVAL = 120;
+
+GpuProfiler::~GpuProfiler() {
+    if (!all_.empty()) glDeleteQueries(GLsizei(all_.size()), all_.data());
+}
+
+GLuint GpuProfiler::acquire() {
+    if (free_.empty()) {
+        GLuint q[16];
+        glGenQueries(16, q);
+        free_.insert(free_.end(), q, q + 16);
+        all_.insert(all_.end(), q, q + 16);
+    }
+    GLuint q = free_.back();
+    free_.pop_back();
+    return q;
+}
+
+void GpuProfiler::calibrate() {
+    GLint64 gpu = 0;
+    glGetInteger64v(GL_TIMESTAMP, &gpu);
+    offsetNs_ = int64_t(Profiler::nowNs()) - int64_t(gpu);
+}
+
+void GpuProfiler::begin(const char* name) {
+    if (frames_ == 0 && inflight_.empty()) calibrate();
+    Zone z{ name, acquire(), acquire(), false };
+    glQueryCounter(z.start, GL_TIMESTAMP);
+    open_.push_back(inflight_.size());
+    inflight_.push_back(z);
+}
+
+void GpuProfiler::end() {
+    if (open_.empty()) return;
+    Zone& z = inflight_[open_.back()];
+    open_.pop_back();
+    glQueryCounter(z.stop, GL_TIMESTAMP);
+    z.closed = true;
+}
+
+void GpuProfiler::collect() {
+    if (++frames_ % CALIBRATE_INTERVAL == 0) calibrate();
+
+    // Results arrive in issue order; stop at the first one still pending
+    size_t done = 0;
+    for (; done < inflight_.size(); ++done) {
+        const Zone& z = inflight_[done];
+        if (!z.closed) break;
+        GLint ready = 0;
+        glGetQueryObjectiv(z.stop, GL_QUERY_RESULT_AVAILABLE, &ready);
+        if (!ready) break;
+
+        GLuint64 t0 = 0, t1 = 0;
+        glGetQueryObjectui64v(z.start, GL_QUERY_RESULT, &t0);
+        glGetQueryObjectui64v(z.stop,  GL_QUERY_RESULT, &t1);
+        Profiler::record(z.name, Profiler::GPU_TRACK,
+                         uint64_t(int64_t(t0) + offsetNs_), t1 > t0 ? t1 - t0 : 0);
+        free_.push_back(z.start);
+        free_.push_back(z.stop);
+    }
+    inflight_.erase(inflight_.begin(), inflight_.begin() + done);
+    for (size_t& i : open_) i -= done;
+}
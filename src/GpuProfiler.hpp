@@ -0,0 +1,59 @@
+// GpuProfiler.hpp
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <vector>
+#include "Profiler.hpp"
+
+// GL timestamp-query zones, reported to Profiler on the GPU track once their
+// results are available (a few frames later, never blocking). Zones nest.
+class GpuProfiler {
+public:
+    GpuProfiler() = default;
+    ~GpuProfiler();
+
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    void begin(const char* name);
+    void end();
+
+    // Hand finished zones to Profiler; call once per frame
+    void collect();
+
+private:
+    struct Zone {
+        const char* name;
+        GLuint      start, stop;
+        bool        closed;
+    };
+
+    GLuint acquire();
+    void   calibrate();
+
+    std::vector<Zone>   inflight_;   // issue order
+    std::vector<size_t> open_;       // indices into inflight_ of unclosed zones
+    std::vector<GLuint> free_;
+    std::vector<GLuint> all_;
+    int64_t             offsetNs_ = 0;   // CPU time − GPU time
+    unsigned            frames_   = 0;
+};
+
+class GpuZone {
+public:
+    GpuZone(GpuProfiler& p, const char* name) : p_(p) { p_.begin(name); }
+    ~GpuZone() { p_.end(); }
+
+    GpuZone(const GpuZone&) = delete;
+    GpuZone& operator=(const GpuZone&) = delete;
+
+private:
+    GpuProfiler& p_;
+};
+
+#if METHARIZON_PROFILE
+#  define PROFILE_GPU_ZONE(profiler, name) GpuZone PROFILE_CONCAT(gpuZone_, __LINE__)(profiler, name)
+#else
+#  define PROFILE_GPU_ZONE(profiler, name) ((void)0)
+#endif
@@ -0,0 +1,206 @@
+// Gravity.cpp
+#include "Gravity.hpp"
+#include "PhysicsKernels.hpp"
+#include "JobSystem.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Softening must stay positive: a body's own term (d = 0) is summed too and
+// only vanishes while the denominator is finite.
+static float softening2(const GravityConfig& cfg) {
+    return std::max(cfg.softening * cfg.softening, 1e-12f);
+}
+
+void Gravity::compute(const GravityConfig& cfg, const PhysicsKernels& kernels,
+                      const GravityBodies& b, float* ax, float* ay, float* az,
+                      JobSystem* jobs)
+{
+    if (cfg.usesExact(b.count)) {
+        computeExact(cfg, kernels, b, ax, ay, az, jobs);
+        return;
+    }
+    if (b.count == 0) return;
+
+    build(b);
+    lists_.resize(jobs ? jobs->threadCount() : 1);
+
+    const float soft2 = softening2(cfg);
+    auto groupRange = [&](size_t begin, size_t end) {
+        InteractionList& list = lists_[jobs ? JobSystem::threadIndex() : 0];
+        for (size_t g = begin; g < end; ++g) {
+            const Group& group = groups_[g];
+            // One interaction list serves every body of the group
+            gatherInteractions(group, cfg.theta, b, list);
+            for (uint32_t k = group.first; k < group.first + group.count; ++k) {
+                uint32_t i = order_[k];
+                float acc[3] = { 0.0f, 0.0f, 0.0f };
+                kernels.gravityAccumulate(list.x.data(), list.y.data(), list.z.data(), list.m.data(),
+                                          list.x.size(), b.x[i], b.y[i], b.z[i], soft2, acc);
+                ax[i] = cfg.G * acc[0];
+                ay[i] = cfg.G * acc[1];
+                az[i] = cfg.G * acc[2];
+            }
+        }
+    };
+    if (jobs) jobs->parallelFor(groups_.size(), 4, groupRange);
+    else      groupRange(0, groups_.size());
+}
+
+void Gravity::computeExact(const GravityConfig& cfg, const PhysicsKernels& kernels,
+                           const GravityBodies& b, float* ax, float* ay, float* az,
+                           JobSystem* jobs)
+{
+    const float soft2 = softening2(cfg);
+    auto bodyRange = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            float acc[3] = { 0.0f, 0.0f, 0.0f };
+            kernels.gravityAccumulate(b.x, b.y, b.z, b.m, b.paddedCount,
+                                      b.x[i], b.y[i], b.z[i], soft2, acc);
+            ax[i] = cfg.G * acc[0];
+            ay[i] = cfg.G * acc[1];
+            az[i] = cfg.G * acc[2];
+        }
+    };
+    if (jobs) jobs->parallelFor(b.count, 64, bodyRange);
+    else      bodyRange(0, b.count);
+}
+
+void Gravity::build(const GravityBodies& b) {
+    uint32_t n = (uint32_t)b.count;
+
+    // --- Bounding cube of all bodies ---
+    glm::vec3 lo(b.x[0], b.y[0], b.z[0]), hi = lo;
+    for (uint32_t i = 1; i < n; ++i) {
+        glm::vec3 p(b.x[i], b.y[i], b.z[i]);
+        lo = glm::min(lo, p);
+        hi = glm::max(hi, p);
+    }
+    glm::vec3 ext = hi - lo;
+    float half = 0.5f * std::max(ext.x, std::max(ext.y, ext.z)) + 1e-4f;
+
+    order_.resize(n);
+    partition_.resize(n);
+    for (uint32_t i = 0; i < n; ++i) order_[i] = i;
+
+    nodes_.clear();
+    groups_.clear();
+    nodes_.push_back(Node{ 0.5f * (lo + hi), half, glm::vec3(0.0f), 0.0f, 0, 0, true });
+    subdivide(0, 0, n, 0, false, b);
+}
+
+void Gravity::subdivide(uint32_t node, uint32_t begin, uint32_t end, int depth, bool grouped,
+                        const GravityBodies& b) {
+    const bool leaf = end - begin <= LEAF_SIZE || depth >= MAX_DEPTH;
+    if (!grouped && (end - begin <= GROUP_SIZE || leaf)) {
+        groups_.push_back(Group{ node, begin, end - begin });
+        grouped = true;
+    }
+
+    // --- Leaf: small enough, or bodies too close to separate ---
+    if (leaf) {
+        glm::vec3 weighted(0.0f);
+        float     m = 0.0f;
+        for (uint32_t k = begin; k < end; ++k) {
+            uint32_t i = order_[k];
+            weighted += glm::vec3(b.x[i], b.y[i], b.z[i]) * b.m[i];
+            m        += b.m[i];
+        }
+        Node& nd = nodes_[node];
+        nd.leaf  = true;
+        nd.first = begin;
+        nd.count = end - begin;
+        nd.mass  = m;
+        nd.com   = m > 0.0f ? weighted / m : nd.center;
+        return;
+    }
+
+    // --- Counting sort of the range into octants ---
+    const glm::vec3 c = nodes_[node].center;
+    auto octant = [&](uint32_t i) {
+        return (b.x[i] > c.x ? 1u : 0u) | (b.y[i] > c.y ? 2u : 0u) | (b.z[i] > c.z ? 4u : 0u);
+    };
+    uint32_t offs[9] = {};
+    for (uint32_t k = begin; k < end; ++k) ++offs[octant(order_[k]) + 1];
+    for (int o = 0; o < 8; ++o) offs[o + 1] += offs[o];
+    uint32_t fill[8];
+    std::copy(offs, offs + 8, fill);
+    for (uint32_t k = begin; k < end; ++k) {
+        uint32_t i = order_[k];
+        partition_[begin + fill[octant(i)]++] = i;
+    }
+    std::copy(partition_.begin() + begin, partition_.begin() + end, order_.begin() + begin);
+
+    // --- Children for non-empty octants, allocated contiguously ---
+    const float q = 0.5f * nodes_[node].halfSize;
+    uint32_t firstChild = (uint32_t)nodes_.size(), childCount = 0;
+    for (int o = 0; o < 8; ++o) {
+        if (offs[o + 1] == offs[o]) continue;
+        glm::vec3 cc = c + glm::vec3((o & 1) ? q : -q, (o & 2) ? q : -q, (o & 4) ? q : -q);
+        nodes_.push_back(Node{ cc, q, glm::vec3(0.0f), 0.0f, 0, 0, true });
+        ++childCount;
+    }
+    uint32_t child = firstChild;
+    for (int o = 0; o < 8; ++o) {
+        if (offs[o + 1] == offs[o]) continue;
+        subdivide(child++, begin + offs[o], begin + offs[o + 1], depth + 1, grouped, b);
+    }
+
+    // --- Aggregate mass & center of mass from children ---
+    glm::vec3 weighted(0.0f);
+    float     m = 0.0f;
+    for (uint32_t k = 0; k < childCount; ++k) {
+        const Node& ch = nodes_[firstChild + k];
+        weighted += ch.com * ch.mass;
+        m        += ch.mass;
+    }
+    Node& nd = nodes_[node];
+    nd.leaf  = false;
+    nd.first = firstChild;
+    nd.count = childCount;
+    nd.mass  = m;
+    nd.com   = m > 0.0f ? weighted / m : nd.center;
+}
+
+void Gravity::gatherInteractions(const Group& target, float theta, const GravityBodies& b,
+                                 InteractionList& list) const
+{
+    list.x.clear(); list.y.clear(); list.z.clear(); list.m.clear();
+    auto push = [&](float x, float y, float z, float m) {
+        list.x.push_back(x); list.y.push_back(y); list.z.push_back(z); list.m.push_back(m);
+    };
+
+    // Sphere about the group's center of mass holding all of its bodies
+    const glm::vec3 com = nodes_[target.node].com;
+    float reach2 = 0.0f;
+    for (uint32_t k = target.first; k < target.first + target.count; ++k) {
+        uint32_t  j = order_[k];
+        glm::vec3 r = glm::vec3(b.x[j], b.y[j], b.z[j]) - com;
+        reach2 = std::max(reach2, glm::dot(r, r));
+    }
+    const float reach = std::sqrt(reach2);
+
+    uint32_t stack[8 * MAX_DEPTH + 8];
+    int sp = 0;
+    stack[sp++] = 0;
+    const float invTheta = 1.0f / theta;
+    while (sp > 0) {
+        const Node& nd = nodes_[stack[--sp]];
+        // s/d < θ, with d from the node's center of mass to the nearest point
+        // of that sphere, so the node is far enough for every group body
+        glm::vec3 r    = nd.com - com;
+        float     open = 2.0f * nd.halfSize * invTheta + reach;
+        if (glm::dot(r, r) > open * open) {
+            push(nd.com.x, nd.com.y, nd.com.z, nd.mass);
+        } else if (nd.leaf) {
+            for (uint32_t k = nd.first; k < nd.first + nd.count; ++k) {
+                uint32_t j = order_[k];
+                push(b.x[j], b.y[j], b.z[j], b.m[j]);
+            }
+        } else {
+            for (uint32_t k = 0; k < nd.count; ++k) stack[sp++] = nd.first + k;
+        }
+    }
+
+    // Pad to whole SIMD vectors with massless entries
+    while (list.x.size() % SIMD_WIDTH != 0) push(com.x, com.y, com.z, 0.0f);
+}
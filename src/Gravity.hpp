@@ -0,0 +1,96 @@
+// Gravity.hpp
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "AlignedAllocator.hpp"
+
+struct PhysicsKernels;
+class JobSystem;
+
+struct GravityConfig {
+    float G         = 200.0f;
+    float softening = 0.1f;
+    float theta     = 0.5f;   // Barnes-Hut opening angle (node size / distance)
+    bool  exact     = false;  // all-pairs reference path, for validation
+    // Below this many bodies the all-pairs sum is faster than building and
+    // walking the tree (MetharizonBench --kernels gravity,exact)
+    size_t exactBelow = 1024;
+
+    // Whether compute() takes the all-pairs path for `count` bodies
+    bool usesExact(size_t count) const { return exact || count < exactBelow; }
+};
+
+// Read-only SoA view of the bodies. Arrays are padded to `paddedCount`
+// entries; padding lanes carry zero mass.
+struct GravityBodies {
+    const float* x;
+    const float* y;
+    const float* z;
+    const float* m;
+    size_t count;
+    size_t paddedCount;
+};
+
+// Barnes-Hut octree gravity. The tree is rebuilt from scratch on every call;
+// nodes live in a flat array so rebuilds reuse the previous allocation.
+// Bodies are walked in groups, the largest subtrees of at most GROUP_SIZE:
+// each group gathers the accepted nodes and near bodies into an SoA
+// interaction list once, and the SIMD gravityAccumulate kernel sums it for
+// every body in the group. A node, leaf or not, is accepted when its size
+// over its distance to the group's bounding sphere is below theta.
+class Gravity {
+public:
+    // Write the gravitational acceleration of every body into ax/ay/az.
+    // Groups are spread over `jobs` when given; every body's sum is the same
+    // whichever thread computes it.
+    void compute(const GravityConfig& cfg, const PhysicsKernels& kernels,
+                 const GravityBodies& bodies, float* ax, float* ay, float* az,
+                 JobSystem* jobs = nullptr);
+
+    // Exact O(n²) sum over all bodies
+    static void computeExact(const GravityConfig& cfg, const PhysicsKernels& kernels,
+                             const GravityBodies& bodies, float* ax, float* ay, float* az,
+                             JobSystem* jobs = nullptr);
+
+    size_t nodeCount() const { return nodes_.size(); }
+
+private:
+    struct Node {
+        glm::vec3 center;      // cell center
+        float     halfSize;    // half edge length of the cube
+        glm::vec3 com;         // center of mass
+        float     mass;
+        uint32_t  first;       // leaf: first slot in order_; inner: first child
+        uint32_t  count;       // leaf: body count; inner: child count
+        bool      leaf;
+    };
+
+    // Bodies of one subtree, summed against one interaction list
+    struct Group {
+        uint32_t node;         // subtree root
+        uint32_t first;        // first slot in order_
+        uint32_t count;
+    };
+
+    struct InteractionList {
+        FloatArray x, y, z, m;
+    };
+
+    static constexpr uint32_t LEAF_SIZE  = 8;
+    static constexpr uint32_t GROUP_SIZE = 64;   // bodies per group, unless a deep leaf holds more
+    static constexpr int      MAX_DEPTH  = 32;
+
+    void build(const GravityBodies& b);
+    void subdivide(uint32_t node, uint32_t begin, uint32_t end, int depth, bool grouped,
+                   const GravityBodies& b);
+    void gatherInteractions(const Group& target, float theta, const GravityBodies& b,
+                            InteractionList& list) const;
+
+    std::vector<Node>            nodes_;
+    std::vector<Group>           groups_;     // the largest subtrees of at most GROUP_SIZE bodies
+    std::vector<uint32_t>        order_;      // body indices, grouped by leaf
+    std::vector<uint32_t>        partition_;  // scratch for subdivide()
+    std::vector<InteractionList> lists_;      // one per job thread
+};
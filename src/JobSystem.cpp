@@ -0,0 +1,157 @@
+// JobSystem.cpp
+#include "JobSystem.hpp"
+#include <cassert>
+
+static thread_local unsigned tlsThreadIndex = 0;
+
+JobSystem::JobSystem(unsigned threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned i = 0; i < threads; ++i)
+        queues_.push_back(std::make_unique<Queue>());
+    for (unsigned i = 1; i < threads; ++i)
+        workers_.emplace_back([this, i] { workerLoop(i); });
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+        running_.store(false);
+    }
+    wake_.notify_all();
+    for (auto& t : workers_) t.join();
+}
+
+unsigned JobSystem::threadIndex() {
+    return tlsThreadIndex;
+}
+
+void JobSystem::run(std::function<void()> job, JobCounter* signal, JobCounter* after) {
+    if (signal) signal->pending_.fetch_add(1, std::memory_order_relaxed);
+
+    if (after) {
+        std::lock_guard<std::mutex> lock(after->mutex_);
+        if (!after->done()) {
+            // Parked on the dependency; released by the job that drains it
+            after->continuations_.push_back(
+                [this, fn = std::move(job), signal]() mutable { push(Job{ std::move(fn), signal }); });
+            return;
+        }
+    }
+    push(Job{ std::move(job), signal });
+}
+
+void JobSystem::enterCaller() {
+    if (threadIndex() != 0) return;
+    const std::thread::id self = std::this_thread::get_id();
+    std::thread::id free{};
+    const bool claimed = caller_.compare_exchange_strong(free, self, std::memory_order_acquire) || free == self;
+    assert(claimed && "two non-worker threads are driving one JobSystem");
+    (void)claimed;
+    ++callerDepth_;
+}
+
+void JobSystem::leaveCaller() {
+    if (threadIndex() != 0) return;
+    if (--callerDepth_ == 0) caller_.store(std::thread::id{}, std::memory_order_release);
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    CallerScope scope(*this);
+    const unsigned self = threadIndex();
+    Job job;
+    while (!counter.done()) {
+        if (pop(self, job)) execute(job);
+        else                std::this_thread::yield();
+    }
+}
+
+void JobSystem::push(Job job) {
+    Queue& q = *queues_[threadIndex()];
+    {
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.pushBack(std::move(job));
+    }
+    queued_.fetch_add(1, std::memory_order_release);
+    {
+        // Empty critical section orders the push before a sleeper's re-check
+        std::lock_guard<std::mutex> lock(sleepMutex_);
+    }
+    wake_.notify_one();
+}
+
+bool JobSystem::pop(unsigned self, Job& out) {
+    if (queued_.load(std::memory_order_acquire) == 0) return false;
+
+    // --- Own queue, newest first ---
+    {
+        Queue& q = *queues_[self];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.empty()) {
+            out = q.popBack();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    // --- Steal the oldest job from the others ---
+    const unsigned n = threadCount();
+    for (unsigned k = 1; k < n; ++k) {
+        Queue& q = *queues_[(self + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (!q.empty()) {
+            out = q.popFront();
+            queued_.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::Queue::pushBack(Job job) {
+    const size_t size = ring.size();
+    if (tail - head == size) {
+        std::vector<Job> grown(2 * size);
+        for (size_t i = head; i != tail; ++i) grown[i - head] = std::move(ring[i & (size - 1)]);
+        ring.swap(grown);
+        tail -= head;
+        head  = 0;
+    }
+    ring[tail++ & (ring.size() - 1)] = std::move(job);
+}
+
+JobSystem::Job JobSystem::Queue::popBack() {
+    return std::move(ring[--tail & (ring.size() - 1)]);
+}
+
+JobSystem::Job JobSystem::Queue::popFront() {
+    return std::move(ring[head++ & (ring.size() - 1)]);
+}
+
+void JobSystem::execute(Job& job) {
+    job.fn();
+    JobCounter* c = job.signal;
+    job = Job{};
+    if (!c) return;
+
+    // Every decrement happens under the counter's mutex, so exactly one job
+    // sees itself as the last and releases the dependants.
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(c->mutex_);
+        if (c->pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            continuations.swap(c->continuations_);
+    }
+    for (auto& cont : continuations) cont();
+}
+
+void JobSystem::workerLoop(unsigned index) {
+    tlsThreadIndex = index;
+    Job job;
+    while (running_.load()) {
+        if (pop(index, job)) {
+            execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex_);
+        wake_.wait(lock, [this] { return !running_.load() || queued_.load() > 0; });
+    }
+}
@@ -0,0 +1,121 @@
+// JobSystem.hpp
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+class JobSystem;
+
+// Completion counter for a batch of jobs. Jobs submitted with this counter as
+// their `signal` bump it on submit and drop it on completion; jobs submitted
+// with it as `after` are held back until it reaches zero.
+class JobCounter {
+public:
+    JobCounter() = default;
+    // The last job may still hold the mutex right after draining the counter
+    ~JobCounter() { std::lock_guard<std::mutex> lock(mutex_); }
+
+    bool done() const { return pending_.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<int>                   pending_{0};
+    std::mutex                         mutex_;
+    std::vector<std::function<void()>> continuations_;
+};
+
+// Work-stealing thread pool. Every thread owns a deque: the owner pushes and
+// pops at the back (LIFO, cache-warm), idle threads steal from the front.
+// Deques are rings that only ever grow, and parallelFor chunks fit in
+// std::function's inline storage, so a steady load does not allocate.
+// Threads that are not pool workers (e.g. the main thread) take slot 0 and
+// help run jobs while they wait. Only one of them may be inside parallelFor
+// or wait at a time, since callers key per-thread scratch on threadIndex();
+// a second one asserts.
+class JobSystem {
+public:
+    // threads = total threads including the caller; 0 = hardware concurrency
+    explicit JobSystem(unsigned threads = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    unsigned threadCount() const { return unsigned(queues_.size()); }
+
+    // Slot of the calling thread in [0, threadCount()); 0 for non-workers
+    static unsigned threadIndex();
+
+    // Queue `job`; it starts once `after` (if any) has drained
+    void run(std::function<void()> job, JobCounter* signal = nullptr, JobCounter* after = nullptr);
+
+    // Run other jobs until `counter` drains
+    void wait(JobCounter& counter);
+
+    // fn(begin, end) over [0, count) in chunks of `grain`. Chunk bounds only
+    // depend on count and grain, never on the thread count.
+    template <class F>
+    void parallelFor(size_t count, size_t grain, F&& fn) {
+        if (count == 0) return;
+        CallerScope scope(*this);
+        grain = std::max<size_t>(grain, 1);
+        if (threadCount() == 1 || count <= grain) {
+            for (size_t b = 0; b < count; b += grain) fn(b, std::min(b + grain, count));
+            return;
+        }
+        // Chunks capture {&range, begin} only: two words stay inline
+        struct Range { std::remove_reference_t<F>* fn; size_t count, grain; } range{ &fn, count, grain };
+        JobCounter done;
+        for (size_t b = 0; b < count; b += grain)
+            run([&range, b] { (*range.fn)(b, std::min(b + range.grain, range.count)); }, &done);
+        wait(done);
+    }
+
+private:
+    // Holds slot 0 for a non-worker thread for the length of a call
+    struct CallerScope {
+        JobSystem& jobs;
+        explicit CallerScope(JobSystem& js) : jobs(js) { jobs.enterCaller(); }
+        ~CallerScope() { jobs.leaveCaller(); }
+    };
+
+    struct Job {
+        std::function<void()> fn;
+        JobCounter*           signal;
+    };
+    // Ring of jobs, oldest at head; the size is a power of two and doubles
+    // when full, never shrinks
+    struct Queue {
+        std::mutex       mutex;
+        std::vector<Job> ring = std::vector<Job>(64);
+        size_t           head = 0, tail = 0;   // unwrapped; slot = index & (size - 1)
+
+        bool empty() const { return head == tail; }
+        void pushBack(Job job);
+        Job  popBack();
+        Job  popFront();
+    };
+
+    void enterCaller();
+    void leaveCaller();
+    void push(Job job);
+    bool pop(unsigned self, Job& out);
+    void execute(Job& job);
+    void workerLoop(unsigned index);
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread>            workers_;
+    std::atomic<int>                    queued_{0};
+    std::atomic<bool>                   running_{true};
+    std::atomic<std::thread::id>        caller_{};        // non-worker holding slot 0
+    int                                 callerDepth_ = 0; // its nested calls
+    std::mutex                          sleepMutex_;
+    std::condition_variable             wake_;
+};
@@ -0,0 +1,28 @@
+// MappedFile.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Whole file mapped read-only; the bytes stay valid until close()
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // False on a missing or empty file (nothing is reported)
+    bool open(const std::string& path);
+    void close();
+
+    const uint8_t* data() const { return data_; }
+    size_t         size() const { return size_; }
+
+private:
+    const uint8_t* data_    = nullptr;
+    size_t         size_    = 0;
+    void*          mapping_ = nullptr;   // platform mapping handle
+};
@@ -0,0 +1,101 @@
+// OffscreenContext.cpp
+#include "OffscreenContext.hpp"
+#include <glad/glad.h>
+#include <EGL/eglext.h>
+#include <cstring>
+#include <iostream>
+
+static bool hasExtension(const char* list, const char* name) {
+    if (!list) return false;
+    const size_t n = std::strlen(name);
+    for (const char* p = list; (p = std::strstr(p, name)); p += n)
+        if ((p == list || p[-1] == ' ') && (p[n] == ' ' || p[n] == '\0')) return true;
+    return false;
+}
+
+static void* loadProc(const char* name) {
+    return reinterpret_cast<void*>(eglGetProcAddress(name));
+}
+
+OffscreenContext::~OffscreenContext() {
+    if (display_ == EGL_NO_DISPLAY) return;
+    eglMakeCurrent(display_, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (surface_ != EGL_NO_SURFACE) eglDestroySurface(display_, surface_);
+    if (context_ != EGL_NO_CONTEXT) eglDestroyContext(display_, context_);
+    eglTerminate(display_);
+}
+
+bool OffscreenContext::init() {
+    // --- Display: surfaceless platform first, then whatever is default ---
+    const char* clientExt = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+    auto getPlatformDisplay = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+        eglGetProcAddress("eglGetPlatformDisplayEXT"));
+    if (getPlatformDisplay && hasExtension(clientExt, "EGL_MESA_platform_surfaceless"))
+        display_ = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+    if (display_ == EGL_NO_DISPLAY) display_ = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+    EGLint major = 0, minor = 0;
+    if (display_ == EGL_NO_DISPLAY || !eglInitialize(display_, &major, &minor)) {
+        std::cerr << "eglInitialize Error: 0x" << std::hex << eglGetError() << std::dec << "\n";
+        display_ = EGL_NO_DISPLAY;
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "eglBindAPI(EGL_OPENGL_API) failed\n";
+        return false;
+    }
+
+    // --- Config: a pbuffer-capable one if there is, any GL one otherwise ---
+    const bool surfaceless = hasExtension(eglQueryString(display_, EGL_EXTENSIONS), "EGL_KHR_surfaceless_context");
+    EGLint attribs[] = {
+        EGL_SURFACE_TYPE,    EGL_PBUFFER_BIT,
+        EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT,
+        EGL_RED_SIZE, 8, EGL_GREEN_SIZE, 8, EGL_BLUE_SIZE, 8,
+        EGL_NONE
+    };
+    EGLConfig config = nullptr;
+    EGLint    found  = 0;
+    if (!eglChooseConfig(display_, attribs, &config, 1, &found) || !found) {
+        attribs[1] = 0;
+        if (!surfaceless || !eglChooseConfig(display_, attribs, &config, 1, &found) || !found) {
+            std::cerr << "No EGL config for desktop OpenGL\n";
+            return false;
+        }
+    }
+
+    const EGLint ctxAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION, 4,
+        EGL_CONTEXT_MINOR_VERSION, 5,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context_ = eglCreateContext(display_, config, EGL_NO_CONTEXT, ctxAttribs);
+    if (context_ == EGL_NO_CONTEXT) {
+        std::cerr << "eglCreateContext Error: 0x" << std::hex << eglGetError() << std::dec << "\n";
+        return false;
+    }
+
+    // --- Current without a surface, or on a 1×1 pbuffer ---
+    if (!surfaceless) {
+        const EGLint pbAttribs[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        surface_ = eglCreatePbufferSurface(display_, config, pbAttribs);
+        if (surface_ == EGL_NO_SURFACE) {
+            std::cerr << "eglCreatePbufferSurface Error: 0x" << std::hex << eglGetError() << std::dec << "\n";
+            return false;
+        }
+    }
+    if (!eglMakeCurrent(display_, surface_, surface_, context_)) {
+        std::cerr << "eglMakeCurrent Error: 0x" << std::hex << eglGetError() << std::dec << "\n";
+        return false;
+    }
+
+    if (!gladLoadGLLoader(loadProc)) {
+        std::cerr << "Failed to initialize GLAD\n";
+        return false;
+    }
+    return true;
+}
+
+const char* OffscreenContext::renderer() const {
+    const GLubyte* r = glGetString(GL_RENDERER);
+    return r ? reinterpret_cast<const char*>(r) : "unknown";
+}
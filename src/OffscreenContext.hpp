@@ -0,0 +1,27 @@
+// OffscreenContext.hpp
+#pragma once
+
+#include <EGL/egl.h>
+
+// OpenGL 4.5 core context without a window or display server: EGL on the
+// surfaceless platform (Mesa, including llvmpipe) where available, else the
+// default display with a 1×1 pbuffer. Rendering goes to FBOs only.
+class OffscreenContext {
+public:
+    OffscreenContext() = default;
+    ~OffscreenContext();
+
+    OffscreenContext(const OffscreenContext&) = delete;
+    OffscreenContext& operator=(const OffscreenContext&) = delete;
+
+    // Create the context, make it current and load GL entry points
+    bool init();
+
+    // GL_RENDERER of the current context, for reports
+    const char* renderer() const;
+
+private:
+    EGLDisplay display_ = EGL_NO_DISPLAY;
+    EGLContext context_ = EGL_NO_CONTEXT;
+    EGLSurface surface_ = EGL_NO_SURFACE;
+};
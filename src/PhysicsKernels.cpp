@@ -0,0 +1,212 @@
+// PhysicsKernels.cpp
+#include "PhysicsKernels.hpp"
+#include <cmath>
+
+#if METHARIZON_X86
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+// Defined in PhysicsKernelsAVX2.cpp, which is the only TU built with AVX2 enabled
+extern const PhysicsKernels avx2PhysicsKernels;
+#endif
+
+// =====================================================================
+// Scalar
+// =====================================================================
+
+static void gravityAccumulateScalar(const float* sx, const float* sy, const float* sz, const float* sm,
+                                    size_t count, float px, float py, float pz, float soft2, float out[3])
+{
+    float ax = 0.0f, ay = 0.0f, az = 0.0f;
+    for (size_t k = 0; k < count; ++k) {
+        float dx = sx[k] - px, dy = sy[k] - py, dz = sz[k] - pz;
+        float r2   = dx*dx + dy*dy + dz*dz + soft2;
+        float inv  = 1.0f / std::sqrt(r2);
+        float s    = sm[k] * inv * inv * inv;
+        ax += dx * s; ay += dy * s; az += dz * s;
+    }
+    out[0] += ax; out[1] += ay; out[2] += az;
+}
+
+static void integrateLinearScalar(float* x, float* y, float* z,
+                                  float* vx, float* vy, float* vz,
+                                  const float* ax, const float* ay, const float* az,
+                                  size_t count, float dt)
+{
+    for (size_t i = 0; i < count; ++i) {
+        vx[i] += ax[i] * dt; vy[i] += ay[i] * dt; vz[i] += az[i] * dt;
+        x[i]  += vx[i] * dt; y[i]  += vy[i] * dt; z[i]  += vz[i] * dt;
+    }
+}
+
+static void integrateSpinScalar(float* qx, float* qy, float* qz, float* qw,
+                                const float* wx, const float* wy, const float* wz,
+                                size_t count, float dt)
+{
+    const float h = 0.5f * dt;
+    for (size_t i = 0; i < count; ++i) {
+        float x = qx[i], y = qy[i], z = qz[i], w = qw[i];
+        float ox = wx[i], oy = wy[i], oz = wz[i];
+        // (0, ω) * q = (-ω·q.xyz, q.w ω + ω × q.xyz)
+        float nw = w + h * -(ox*x + oy*y + oz*z);
+        float nx = x + h * (w*ox + (oy*z - oz*y));
+        float ny = y + h * (w*oy + (oz*x - ox*z));
+        float nz = z + h * (w*oz + (ox*y - oy*x));
+        float inv = 1.0f / std::sqrt(nx*nx + ny*ny + nz*nz + nw*nw);
+        qx[i] = nx * inv; qy[i] = ny * inv; qz[i] = nz * inv; qw[i] = nw * inv;
+    }
+}
+
+static const PhysicsKernels scalarPhysicsKernels = {
+    SimdLevel::Scalar, "scalar",
+    gravityAccumulateScalar, integrateLinearScalar, integrateSpinScalar
+};
+
+// =====================================================================
+// SSE2 (x86-64 baseline)
+// =====================================================================
+#if METHARIZON_X86
+
+static float hsum(__m128 v) {
+    __m128 s = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+static void gravityAccumulateSSE2(const float* sx, const float* sy, const float* sz, const float* sm,
+                                  size_t count, float px, float py, float pz, float soft2, float out[3])
+{
+    const __m128 vpx = _mm_set1_ps(px), vpy = _mm_set1_ps(py), vpz = _mm_set1_ps(pz);
+    const __m128 vs2 = _mm_set1_ps(soft2), one = _mm_set1_ps(1.0f);
+    __m128 ax = _mm_setzero_ps(), ay = _mm_setzero_ps(), az = _mm_setzero_ps();
+    for (size_t k = 0; k < count; k += 4) {
+        __m128 dx = _mm_sub_ps(_mm_load_ps(sx + k), vpx);
+        __m128 dy = _mm_sub_ps(_mm_load_ps(sy + k), vpy);
+        __m128 dz = _mm_sub_ps(_mm_load_ps(sz + k), vpz);
+        __m128 r2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                               _mm_add_ps(_mm_mul_ps(dz, dz), vs2));
+        __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(r2));
+        __m128 s   = _mm_mul_ps(_mm_load_ps(sm + k), _mm_mul_ps(inv, _mm_mul_ps(inv, inv)));
+        ax = _mm_add_ps(ax, _mm_mul_ps(dx, s));
+        ay = _mm_add_ps(ay, _mm_mul_ps(dy, s));
+        az = _mm_add_ps(az, _mm_mul_ps(dz, s));
+    }
+    out[0] += hsum(ax); out[1] += hsum(ay); out[2] += hsum(az);
+}
+
+static void integrateLinearSSE2(float* x, float* y, float* z,
+                                float* vx, float* vy, float* vz,
+                                const float* ax, const float* ay, const float* az,
+                                size_t count, float dt)
+{
+    const __m128 vdt = _mm_set1_ps(dt);
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 nvx = _mm_add_ps(_mm_load_ps(vx + i), _mm_mul_ps(_mm_load_ps(ax + i), vdt));
+        __m128 nvy = _mm_add_ps(_mm_load_ps(vy + i), _mm_mul_ps(_mm_load_ps(ay + i), vdt));
+        __m128 nvz = _mm_add_ps(_mm_load_ps(vz + i), _mm_mul_ps(_mm_load_ps(az + i), vdt));
+        _mm_store_ps(vx + i, nvx); _mm_store_ps(vy + i, nvy); _mm_store_ps(vz + i, nvz);
+        _mm_store_ps(x + i, _mm_add_ps(_mm_load_ps(x + i), _mm_mul_ps(nvx, vdt)));
+        _mm_store_ps(y + i, _mm_add_ps(_mm_load_ps(y + i), _mm_mul_ps(nvy, vdt)));
+        _mm_store_ps(z + i, _mm_add_ps(_mm_load_ps(z + i), _mm_mul_ps(nvz, vdt)));
+    }
+}
+
+static void integrateSpinSSE2(float* qx, float* qy, float* qz, float* qw,
+                              const float* wx, const float* wy, const float* wz,
+                              size_t count, float dt)
+{
+    const __m128 h = _mm_set1_ps(0.5f * dt), one = _mm_set1_ps(1.0f);
+    for (size_t i = 0; i < count; i += 4) {
+        __m128 x = _mm_load_ps(qx + i), y = _mm_load_ps(qy + i);
+        __m128 z = _mm_load_ps(qz + i), w = _mm_load_ps(qw + i);
+        __m128 ox = _mm_load_ps(wx + i), oy = _mm_load_ps(wy + i), oz = _mm_load_ps(wz + i);
+
+        __m128 dotv = _mm_add_ps(_mm_add_ps(_mm_mul_ps(ox, x), _mm_mul_ps(oy, y)), _mm_mul_ps(oz, z));
+        __m128 nw = _mm_sub_ps(w, _mm_mul_ps(h, dotv));
+        __m128 nx = _mm_add_ps(x, _mm_mul_ps(h, _mm_add_ps(_mm_mul_ps(w, ox),
+                                   _mm_sub_ps(_mm_mul_ps(oy, z), _mm_mul_ps(oz, y)))));
+        __m128 ny = _mm_add_ps(y, _mm_mul_ps(h, _mm_add_ps(_mm_mul_ps(w, oy),
+                                   _mm_sub_ps(_mm_mul_ps(oz, x), _mm_mul_ps(ox, z)))));
+        __m128 nz = _mm_add_ps(z, _mm_mul_ps(h, _mm_add_ps(_mm_mul_ps(w, oz),
+                                   _mm_sub_ps(_mm_mul_ps(ox, y), _mm_mul_ps(oy, x)))));
+
+        __m128 len2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, nx), _mm_mul_ps(ny, ny)),
+                                 _mm_add_ps(_mm_mul_ps(nz, nz), _mm_mul_ps(nw, nw)));
+        __m128 inv = _mm_div_ps(one, _mm_sqrt_ps(len2));
+        _mm_store_ps(qx + i, _mm_mul_ps(nx, inv));
+        _mm_store_ps(qy + i, _mm_mul_ps(ny, inv));
+        _mm_store_ps(qz + i, _mm_mul_ps(nz, inv));
+        _mm_store_ps(qw + i, _mm_mul_ps(nw, inv));
+    }
+}
+
+static const PhysicsKernels sse2PhysicsKernels = {
+    SimdLevel::SSE2, "sse2",
+    gravityAccumulateSSE2, integrateLinearSSE2, integrateSpinSSE2
+};
+
+// =====================================================================
+// Dispatch
+// =====================================================================
+
+static void cpuid(int out[4], int leaf, int sub) {
+#if defined(_MSC_VER)
+    __cpuidex(out, leaf, sub);
+#else
+    unsigned a, b, c, d;
+    __cpuid_count(leaf, sub, a, b, c, d);
+    out[0] = (int)a; out[1] = (int)b; out[2] = (int)c; out[3] = (int)d;
+#endif
+}
+
+static unsigned long long xgetbv0() {
+#if defined(_MSC_VER)
+    return _xgetbv(0);
+#else
+    unsigned lo, hi;
+    __asm__ volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((unsigned long long)hi << 32) | lo;
+#endif
+}
+
+SimdLevel detectSimdLevel() {
+    int r[4];
+    cpuid(r, 0, 0);
+    if (r[0] < 7) return SimdLevel::SSE2;
+
+    cpuid(r, 1, 0);
+    bool osxsave = (r[2] & (1 << 27)) != 0;
+    bool fma     = (r[2] & (1 << 12)) != 0;
+    bool avx     = (r[2] & (1 << 28)) != 0;
+    // The OS must save YMM state across context switches
+    bool ymm     = osxsave && (xgetbv0() & 0x6) == 0x6;
+
+    cpuid(r, 7, 0);
+    bool avx2 = (r[1] & (1 << 5)) != 0;
+    return (avx && avx2 && fma && ymm) ? SimdLevel::AVX2 : SimdLevel::SSE2;
+}
+
+#else
+
+SimdLevel detectSimdLevel() { return SimdLevel::Scalar; }
+
+#endif
+
+const PhysicsKernels& physicsKernels(SimdLevel level) {
+    static const SimdLevel best = detectSimdLevel();
+    if ((int)level > (int)best) level = best;
+    switch (level) {
+#if METHARIZON_X86
+    case SimdLevel::AVX2: return avx2PhysicsKernels;
+    case SimdLevel::SSE2: return sse2PhysicsKernels;
+#endif
+    default:              return scalarPhysicsKernels;
+    }
+}
+
+const PhysicsKernels& physicsKernels() {
+    return physicsKernels(SimdLevel::AVX2);
+}
@@ -0,0 +1,44 @@
+// PhysicsKernels.hpp
+#pragma once
+
+#include <cstddef>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define METHARIZON_X86 1
+#endif
+
+enum class SimdLevel { Scalar = 0, SSE2 = 1, AVX2 = 2 };
+
+// SoA arrays are padded to a multiple of this many floats (one AVX register)
+constexpr size_t SIMD_WIDTH = 8;
+
+// Hot loops of PhysicsWorld, one table per instruction set. Every `count` is a
+// multiple of SIMD_WIDTH and every array is 64-byte aligned.
+struct PhysicsKernels {
+    SimdLevel   level;
+    const char* name;
+
+    // out += Σ_j m_j (s_j - p) / (|s_j - p|² + soft2)^(3/2)
+    void (*gravityAccumulate)(const float* sx, const float* sy, const float* sz, const float* sm,
+                              size_t count, float px, float py, float pz, float soft2, float out[3]);
+
+    // v += a * dt; x += v * dt
+    void (*integrateLinear)(float* x, float* y, float* z,
+                            float* vx, float* vy, float* vz,
+                            const float* ax, const float* ay, const float* az,
+                            size_t count, float dt);
+
+    // q = normalize(q + 0.5 * dt * (0, w) * q)
+    void (*integrateSpin)(float* qx, float* qy, float* qz, float* qw,
+                          const float* wx, const float* wy, const float* wz,
+                          size_t count, float dt);
+};
+
+// Widest instruction set the CPU and OS support
+SimdLevel detectSimdLevel();
+
+// Kernels for `level`, clamped to detectSimdLevel()
+const PhysicsKernels& physicsKernels(SimdLevel level);
+
+// Best kernels for this machine (detected once)
+const PhysicsKernels& physicsKernels();
@@ -0,0 +1,83 @@
+// PhysicsKernelsAVX2.cpp
+// Built with AVX2/FMA code generation (see CMakeLists.txt); nothing in here
+// runs unless detectSimdLevel() reported AVX2.
+#include "PhysicsKernels.hpp"
+
+#if METHARIZON_X86
+#include <immintrin.h>
+
+static float hsum(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+static void gravityAccumulateAVX2(const float* sx, const float* sy, const float* sz, const float* sm,
+                                  size_t count, float px, float py, float pz, float soft2, float out[3])
+{
+    const __m256 vpx = _mm256_set1_ps(px), vpy = _mm256_set1_ps(py), vpz = _mm256_set1_ps(pz);
+    const __m256 vs2 = _mm256_set1_ps(soft2), one = _mm256_set1_ps(1.0f);
+    __m256 ax = _mm256_setzero_ps(), ay = _mm256_setzero_ps(), az = _mm256_setzero_ps();
+    for (size_t k = 0; k < count; k += 8) {
+        __m256 dx = _mm256_sub_ps(_mm256_load_ps(sx + k), vpx);
+        __m256 dy = _mm256_sub_ps(_mm256_load_ps(sy + k), vpy);
+        __m256 dz = _mm256_sub_ps(_mm256_load_ps(sz + k), vpz);
+        __m256 r2 = _mm256_fmadd_ps(dx, dx, _mm256_fmadd_ps(dy, dy, _mm256_fmadd_ps(dz, dz, vs2)));
+        __m256 inv = _mm256_div_ps(one, _mm256_sqrt_ps(r2));
+        __m256 s   = _mm256_mul_ps(_mm256_load_ps(sm + k), _mm256_mul_ps(inv, _mm256_mul_ps(inv, inv)));
+        ax = _mm256_fmadd_ps(dx, s, ax);
+        ay = _mm256_fmadd_ps(dy, s, ay);
+        az = _mm256_fmadd_ps(dz, s, az);
+    }
+    out[0] += hsum(ax); out[1] += hsum(ay); out[2] += hsum(az);
+}
+
+static void integrateLinearAVX2(float* x, float* y, float* z,
+                                float* vx, float* vy, float* vz,
+                                const float* ax, const float* ay, const float* az,
+                                size_t count, float dt)
+{
+    const __m256 vdt = _mm256_set1_ps(dt);
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 nvx = _mm256_fmadd_ps(_mm256_load_ps(ax + i), vdt, _mm256_load_ps(vx + i));
+        __m256 nvy = _mm256_fmadd_ps(_mm256_load_ps(ay + i), vdt, _mm256_load_ps(vy + i));
+        __m256 nvz = _mm256_fmadd_ps(_mm256_load_ps(az + i), vdt, _mm256_load_ps(vz + i));
+        _mm256_store_ps(vx + i, nvx); _mm256_store_ps(vy + i, nvy); _mm256_store_ps(vz + i, nvz);
+        _mm256_store_ps(x + i, _mm256_fmadd_ps(nvx, vdt, _mm256_load_ps(x + i)));
+        _mm256_store_ps(y + i, _mm256_fmadd_ps(nvy, vdt, _mm256_load_ps(y + i)));
+        _mm256_store_ps(z + i, _mm256_fmadd_ps(nvz, vdt, _mm256_load_ps(z + i)));
+    }
+}
+
+static void integrateSpinAVX2(float* qx, float* qy, float* qz, float* qw,
+                              const float* wx, const float* wy, const float* wz,
+                              size_t count, float dt)
+{
+    const __m256 h = _mm256_set1_ps(0.5f * dt), one = _mm256_set1_ps(1.0f);
+    for (size_t i = 0; i < count; i += 8) {
+        __m256 x = _mm256_load_ps(qx + i), y = _mm256_load_ps(qy + i);
+        __m256 z = _mm256_load_ps(qz + i), w = _mm256_load_ps(qw + i);
+        __m256 ox = _mm256_load_ps(wx + i), oy = _mm256_load_ps(wy + i), oz = _mm256_load_ps(wz + i);
+
+        __m256 dotv = _mm256_fmadd_ps(ox, x, _mm256_fmadd_ps(oy, y, _mm256_mul_ps(oz, z)));
+        __m256 nw = _mm256_fnmadd_ps(h, dotv, w);
+        __m256 nx = _mm256_fmadd_ps(h, _mm256_fmadd_ps(w, ox, _mm256_fmsub_ps(oy, z, _mm256_mul_ps(oz, y))), x);
+        __m256 ny = _mm256_fmadd_ps(h, _mm256_fmadd_ps(w, oy, _mm256_fmsub_ps(oz, x, _mm256_mul_ps(ox, z))), y);
+        __m256 nz = _mm256_fmadd_ps(h, _mm256_fmadd_ps(w, oz, _mm256_fmsub_ps(ox, y, _mm256_mul_ps(oy, x))), z);
+
+        __m256 len2 = _mm256_fmadd_ps(nx, nx, _mm256_fmadd_ps(ny, ny, _mm256_fmadd_ps(nz, nz, _mm256_mul_ps(nw, nw))));
+        __m256 inv  = _mm256_div_ps(one, _mm256_sqrt_ps(len2));
+        _mm256_store_ps(qx + i, _mm256_mul_ps(nx, inv));
+        _mm256_store_ps(qy + i, _mm256_mul_ps(ny, inv));
+        _mm256_store_ps(qz + i, _mm256_mul_ps(nz, inv));
+        _mm256_store_ps(qw + i, _mm256_mul_ps(nw, inv));
+    }
+}
+
+extern const PhysicsKernels avx2PhysicsKernels = {
+    SimdLevel::AVX2, "avx2",
+    gravityAccumulateAVX2, integrateLinearAVX2, integrateSpinAVX2
+};
+
+#endif
@@ -0,0 +1,272 @@
+// PhysicsWorld.cpp
+#include "PhysicsWorld.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Bodies per job; a multiple of SIMD_WIDTH so kernel chunks stay aligned
+static constexpr size_t BODY_GRAIN = 1024;
+
+// Bodies per batched SDF query
+static constexpr size_t SDF_BATCH = 256;
+
+PhysicsWorld::PhysicsWorld()
+    : kernels_(&physicsKernels()) {}
+
+template <class F>
+void PhysicsWorld::forRange(size_t count, size_t grain, F&& fn) {
+    if (jobs_) jobs_->parallelFor(count, grain, fn);
+    else       fn(size_t(0), count);
+}
+
+std::array<FloatArray*, 18> PhysicsWorld::zeroPadded() {
+    return { &x_, &y_, &z_, &vx_, &vy_, &vz_, &ax_, &ay_, &az_,
+             &radius_, &mass_, &inertia_, &qx_, &qy_, &qz_, &wx_, &wy_, &wz_ };
+}
+
+void PhysicsWorld::resizeBodies(size_t count) {
+    // --- Whole SIMD registers; new padding lanes are inert ---
+    size_t padded = (count + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    if (padded == x_.size()) return;
+    for (FloatArray* a : zeroPadded()) a->resize(padded, 0.0f);
+    qw_.resize(padded, 1.0f);
+    ids_.resize(padded, 0u);
+}
+
+unsigned PhysicsWorld::spawn(const glm::vec3& pos, float radius, float mass, float inertia) {
+    const BodyDesc desc{ pos, radius, mass, inertia };
+    unsigned id = 0;
+    spawn(&desc, 1, &id);
+    return id;
+}
+
+void PhysicsWorld::spawn(const BodyDesc* bodies, size_t count, unsigned* ids) {
+    const size_t first = count_;
+    if (count > SlotMap::MAX_SLOTS) count = SlotMap::MAX_SLOTS;
+    // Grow geometrically so repeated single spawns stay amortized O(1)
+    if (first + count > x_.capacity()) {
+        size_t cap = std::max(first + count, x_.capacity() * 2) + SIMD_WIDTH;
+        for (FloatArray* a : zeroPadded()) a->reserve(cap);
+        qw_.reserve(cap);
+        ids_.reserve(cap);
+    }
+    resizeBodies(first + count);
+
+    size_t n = 0;
+    for (; n < count; ++n) {
+        size_t   i  = first + n;
+        unsigned id = slots_.insert(uint32_t(i));
+        if (!id) break;
+        const BodyDesc& b = bodies[n];
+        setPosition(i, b.pos);
+        setVelocity(i, b.vel);
+        setAngularVelocity(i, b.angVel);
+        qx_[i] = b.orient.x; qy_[i] = b.orient.y; qz_[i] = b.orient.z; qw_[i] = b.orient.w;
+        radius_ [i] = b.radius;
+        mass_   [i] = b.mass;
+        inertia_[i] = b.inertia;
+        ids_    [i] = id;
+        if (ids) ids[n] = id;
+    }
+    for (size_t k = n; k < count && ids; ++k) ids[k] = 0;
+
+    count_ = first + n;
+    resizeBodies(count_);
+    dirty_   .add(first, count_);
+    idsDirty_.add(first, count_);
+}
+
+bool PhysicsWorld::assign(const BodyArrays& b) {
+    const size_t n = b.count;
+    if (n > SlotMap::MAX_SLOTS) return false;
+    SlotMap slots;
+    if (b.ids) {
+        if (!slots.assign(b.ids, n)) return false;
+    } else {
+        slots.reserve(n);
+    }
+
+    // --- Fresh arrays: the given ones or defaults, then inert padding ---
+    const size_t padded = (n + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+    auto load = [n, padded](FloatArray& dst, const float* src, float fill) {
+        dst.clear();
+        dst.reserve(padded);
+        if (src) dst.assign(src, src + n);
+        else     dst.assign(n, fill);
+        dst.resize(padded, fill);
+    };
+    load(x_, b.x, 0.0f);   load(y_, b.y, 0.0f);   load(z_, b.z, 0.0f);
+    load(vx_, b.vx, 0.0f); load(vy_, b.vy, 0.0f); load(vz_, b.vz, 0.0f);
+    load(ax_, nullptr, 0.0f); load(ay_, nullptr, 0.0f); load(az_, nullptr, 0.0f);
+    load(radius_, b.radius, 0.0f); load(mass_, b.mass, 0.0f); load(inertia_, b.inertia, 0.0f);
+    load(qx_, b.qx, 0.0f); load(qy_, b.qy, 0.0f); load(qz_, b.qz, 0.0f); load(qw_, b.qw, 1.0f);
+    load(wx_, b.wx, 0.0f); load(wy_, b.wy, 0.0f); load(wz_, b.wz, 0.0f);
+    if (!b.inertia)
+        for (size_t i = 0; i < n; ++i) inertia_[i] = 0.4f * mass_[i] * radius_[i] * radius_[i];
+
+    ids_.assign(padded, 0u);
+    if (b.ids) std::copy(b.ids, b.ids + n, ids_.begin());
+    else for (size_t i = 0; i < n; ++i) ids_[i] = slots.insert(uint32_t(i));
+    slots_ = std::move(slots);
+
+    count_ = n;
+    dirty_   .add(0, n);
+    idsDirty_.add(0, n);
+    return true;
+}
+
+bool PhysicsWorld::despawn(unsigned id) {
+    const size_t i = slots_.index(id);
+    if (i == SlotMap::npos) return false;
+    slots_.erase(id);
+
+    // --- Swap-remove: the last body takes index i, its lane becomes padding ---
+    const size_t last = --count_;
+    for (FloatArray* a : zeroPadded()) {
+        (*a)[i]    = (*a)[last];
+        (*a)[last] = 0.0f;
+    }
+    qw_ [i] = qw_ [last]; qw_ [last] = 1.0f;
+    ids_[i] = ids_[last]; ids_[last] = 0u;
+    if (i != last) slots_.move(ids_[i], uint32_t(i));
+
+    resizeBodies(count_);
+    dirty_   .add(i, i + 1);
+    idsDirty_.add(i, i + 1);
+    return true;
+}
+
+void PhysicsWorld::step(const PhysicsConfig& cfg, float dt) {
+    if (count_ == 0) return;
+    PROFILE_ZONE("physics step");
+    dirty_.add(0, count_);
+    const float  dt_s   = dt / float(cfg.substeps);
+    const size_t padded = paddedSize();
+    const GravityBodies bodies{ x_.data(), y_.data(), z_.data(), mass_.data(), count_, padded };
+
+    sdf_.setTransform(cfg.sdfXform);
+    sdf_.setBaseCache(cfg.sdfCache);
+
+    for (int step = 0; step < cfg.substeps; ++step) {
+        frame_.reset();
+        // 1) Gravity
+        {
+            PROFILE_ZONE("gravity");
+            gravity_.compute(cfg.gravity, *kernels_, bodies, ax_.data(), ay_.data(), az_.data(), jobs_);
+        }
+        // 2) Integrate linear
+        {
+            PROFILE_ZONE("integrate");
+            forRange(padded, BODY_GRAIN, [&](size_t b, size_t e) {
+                kernels_->integrateLinear(x_.data() + b, y_.data() + b, z_.data() + b,
+                                          vx_.data() + b, vy_.data() + b, vz_.data() + b,
+                                          ax_.data() + b, ay_.data() + b, az_.data() + b, e - b, dt_s);
+            });
+        }
+        // 3) Sphere–sphere collisions
+        {
+            PROFILE_ZONE("collide spheres");
+            collideSpheres(cfg);
+        }
+        // 4) Sphere–SDF collisions, then 5) integrate spin; both per body
+        {
+            PROFILE_ZONE("collide sdf + spin");
+            forRange(padded, BODY_GRAIN, [&](size_t b, size_t e) {
+                collideSDF(cfg, b, std::min(e, count_));
+                kernels_->integrateSpin(qx_.data() + b, qy_.data() + b, qz_.data() + b, qw_.data() + b,
+                                        wx_.data() + b, wy_.data() + b, wz_.data() + b, e - b, dt_s);
+            });
+        }
+    }
+}
+
+void PhysicsWorld::collideSpheres(const PhysicsConfig& cfg) {
+    const float restitution = cfg.restitution, mu = cfg.mu;
+    for (const BodyPair& pair : broadphase_.findPairs(x_.data(), y_.data(), z_.data(), radius_.data(), count_, frame_)) {
+        size_t i = pair.a, j = pair.b;
+        glm::vec3 pi = position(i), pj = position(j);
+        glm::vec3 d = pj - pi;
+        float dist2 = glm::dot(d, d);
+        float Rsum  = radius_[i] + radius_[j];
+        if (dist2 >= Rsum * Rsum) continue;
+
+        float dist = std::sqrt(dist2);
+        glm::vec3 N = dist > 0 ? d / dist : glm::vec3(1, 0, 0);
+        // unstuck
+        float pen = Rsum - dist;
+        pi -= 0.5f * pen * N;
+        pj += 0.5f * pen * N;
+        setPosition(i, pi);
+        setPosition(j, pj);
+
+        // relative velocity at contact
+        glm::vec3 vi = velocity(i), vj = velocity(j);
+        glm::vec3 wi = angularVelocity(i), wj = angularVelocity(j);
+        glm::vec3 rA =  N * radius_[i];
+        glm::vec3 rB = -N * radius_[j];
+        glm::vec3 vA = vi + glm::cross(wi, rA);
+        glm::vec3 vB = vj + glm::cross(wj, rB);
+        glm::vec3 relV = vB - vA;
+
+        // normal impulse
+        float vn = glm::dot(relV, N);
+        if (vn >= 0.0f) continue;
+        float invM = 1.0f / mass_[i] + 1.0f / mass_[j];
+        float Jn = -(1.0f + restitution) * vn / invM;
+        glm::vec3 J = Jn * N;
+
+        vi -= J * (1.0f / mass_[i]);
+        vj += J * (1.0f / mass_[j]);
+
+        // contact points relative to each center are rA / rB
+        wi += glm::cross(rA, -J) / inertia_[i];
+        wj += glm::cross(rB, +J) / inertia_[j];
+
+        // friction (Coulomb)
+        glm::vec3 vt = relV - vn * N;
+        float vt_len = glm::length(vt);
+        if (vt_len > 1e-4f) {
+            glm::vec3 tdir = vt / vt_len;
+            float Jt = glm::min(mu * Jn, vt_len * mass_[i]);
+            glm::vec3 Jf = -Jt * tdir;
+            vi -= Jf * (1.0f / mass_[i]);
+            vj += Jf * (1.0f / mass_[j]);
+            // torque from friction
+            wi += glm::cross(rA, -Jf) / inertia_[i];
+            wj += glm::cross(rB, +Jf) / inertia_[j];
+        }
+        setVelocity(i, vi);
+        setVelocity(j, vj);
+        setAngularVelocity(i, wi);
+        setAngularVelocity(j, wj);
+    }
+}
+
+void PhysicsWorld::collideSDF(const PhysicsConfig& cfg, size_t begin, size_t end) {
+    alignas(64) float d[SDF_BATCH], gx[SDF_BATCH], gy[SDF_BATCH], gz[SDF_BATCH];
+
+    for (size_t base = begin; base < end; base += SDF_BATCH) {
+        const size_t n = std::min(SDF_BATCH, end - base);
+        sdf_.evaluate(x_.data() + base, y_.data() + base, z_.data() + base, n, d, gx, gy, gz);
+
+        for (size_t k = 0; k < n; ++k) {
+            size_t i = base + k;
+            if (d[k] >= radius_[i]) continue;
+
+            glm::vec3 g(gx[k], gy[k], gz[k]);
+            float gl = glm::length(g);
+            glm::vec3 N = gl > 0.0f ? g / gl : glm::vec3(0, 1, 0);
+            float pen = radius_[i] - d[k];
+            setPosition(i, position(i) + N * pen);
+
+            glm::vec3 v0 = velocity(i);
+            glm::vec3 J = mass_[i] * (glm::reflect(v0, N) * cfg.restitution - v0);
+            setVelocity(i, v0 + J / mass_[i]);
+
+            // contact point relative to the center
+            glm::vec3 r = -N * radius_[i];
+            setAngularVelocity(i, angularVelocity(i) + glm::cross(r, J) / inertia_[i]);
+        }
+    }
+}
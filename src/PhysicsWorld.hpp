@@ -0,0 +1,178 @@
+// PhysicsWorld.hpp
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <array>
+#include <vector>
+#include "AlignedAllocator.hpp"
+#include "Broadphase.hpp"
+#include "FrameArena.hpp"
+#include "Gravity.hpp"
+#include "PhysicsKernels.hpp"
+#include "SceneSDF.hpp"
+#include "SlotMap.hpp"
+
+class BrickMap;
+class JobSystem;
+
+struct PhysicsConfig {
+    GravityConfig gravity;
+    float     restitution = 1.0f;
+    float     mu          = 0.2f;   // Coulomb friction
+    int       substeps    = 4;
+    glm::mat4 sdfXform{1.0f};       // object transform of the static SDF
+    const BrickMap* sdfCache = nullptr;  // baked base SDF; null = analytic
+};
+
+struct BodyDesc {
+    glm::vec3 pos;
+    float     radius, mass, inertia;
+    glm::vec3 vel{0.0f};
+    glm::quat orient{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 angVel{0.0f};
+};
+
+// Read-only SoA view of bodies, what renderers and recorders consume; arrays
+// hold at least `count` entries
+struct BodyView {
+    const float    *x, *y, *z, *radius;
+    const float    *qx, *qy, *qz, *qw;
+    const unsigned *ids;
+    size_t          count;
+    DirtyRange      dirty, idsDirty;   // see PhysicsWorld::dirty()
+};
+
+// SoA source for a bulk load, `count` entries per array. Optional arrays
+// may be null: inertia then defaults to a solid sphere's, velocities to
+// zero and ids to fresh ones.
+struct BodyArrays {
+    const float    *x, *y, *z, *radius, *mass;
+    const float    *qx, *qy, *qz, *qw;
+    const float    *inertia = nullptr;
+    const float    *vx = nullptr, *vy = nullptr, *vz = nullptr;
+    const float    *wx = nullptr, *wy = nullptr, *wz = nullptr;
+    const unsigned *ids = nullptr;
+    size_t          count = 0;
+};
+
+// Rigid spheres in structure-of-arrays layout: one float array per component,
+// 64-byte aligned and padded to a multiple of SIMD_WIDTH. Padding lanes hold
+// inert values (zero mass, identity orientation) so the SIMD kernels can run
+// over whole registers without remainder loops. Bodies are addressed by
+// generational ids (see SlotMap) that stay valid while their index moves:
+// despawning swaps the last body into the hole, keeping the arrays packed.
+class PhysicsWorld {
+public:
+    PhysicsWorld();
+
+    // Add a body at rest; returns its id (0 if the id space is exhausted)
+    unsigned spawn(const glm::vec3& pos, float radius, float mass, float inertia);
+
+    // Add `count` bodies with one resize per array; their ids go to `ids`
+    // if given
+    void spawn(const BodyDesc* bodies, size_t count, unsigned* ids = nullptr);
+
+    // Replace every body with `bodies`, one copy per array. Given ids are
+    // kept, so handles saved with a scene stay valid; false (world
+    // unchanged) if one is 0 or two share a slot.
+    bool assign(const BodyArrays& bodies);
+
+    // Remove a body in O(1); false if the id is stale
+    bool despawn(unsigned id);
+
+    // Current index of a live body, or SlotMap::npos
+    size_t indexOf(unsigned id) const { return slots_.index(id); }
+    bool   alive  (unsigned id) const { return slots_.contains(id); }
+
+    // Indices whose data changed since clearDirty(): any per-body data, and
+    // ids alone (which only change on spawn and despawn)
+    const DirtyRange& dirty()    const { return dirty_; }
+    const DirtyRange& idsDirty() const { return idsDirty_; }
+    void clearDirty() { dirty_.clear(); idsDirty_.clear(); }
+
+    // Advance the simulation by dt, split into cfg.substeps
+    void step(const PhysicsConfig& cfg, float dt);
+
+    // Spread gravity, integration and sphere–SDF contacts over `jobs`
+    // (nullptr = run on the calling thread). Results do not depend on the
+    // thread count; sphere–sphere contacts stay serial, their order matters.
+    void setJobSystem(JobSystem* jobs) { jobs_ = jobs; }
+
+    // Force a kernel set, e.g. SimdLevel::Scalar for validation
+    void setSimdLevel(SimdLevel level) { kernels_ = &physicsKernels(level); }
+    const PhysicsKernels& kernels() const { return *kernels_; }
+
+    size_t size()       const { return count_; }
+    size_t paddedSize() const { return x_.size(); }
+
+    glm::vec3 position   (size_t i) const { return glm::vec3(x_[i], y_[i], z_[i]); }
+    glm::vec3 velocity   (size_t i) const { return glm::vec3(vx_[i], vy_[i], vz_[i]); }
+    glm::quat orientation(size_t i) const { return glm::quat(qw_[i], qx_[i], qy_[i], qz_[i]); }
+
+    // Component arrays, paddedSize() entries each
+    const float*    x()      const { return x_.data(); }
+    const float*    y()      const { return y_.data(); }
+    const float*    z()      const { return z_.data(); }
+    const float*    radii()  const { return radius_.data(); }
+    const float*    masses() const { return mass_.data(); }
+    const float*    qx()     const { return qx_.data(); }
+    const float*    qy()     const { return qy_.data(); }
+    const float*    qz()     const { return qz_.data(); }
+    const float*    qw()     const { return qw_.data(); }
+    const unsigned* ids()    const { return ids_.data(); }
+    const float*    inertias() const { return inertia_.data(); }
+    const float*    vx()     const { return vx_.data(); }
+    const float*    vy()     const { return vy_.data(); }
+    const float*    vz()     const { return vz_.data(); }
+    const float*    wx()     const { return wx_.data(); }
+    const float*    wy()     const { return wy_.data(); }
+    const float*    wz()     const { return wz_.data(); }
+
+    BodyView view() const {
+        return { x_.data(), y_.data(), z_.data(), radius_.data(),
+                 qx_.data(), qy_.data(), qz_.data(), qw_.data(), ids_.data(), count_, dirty_, idsDirty_ };
+    }
+
+    const Broadphase& broadphase() const { return broadphase_; }
+    // Scratch of one substep (broadphase grid and pairs), reset as each begins
+    const FrameArena& frameArena() const { return frame_; }
+    // Static scene the bodies collide with: the base of map(), without the
+    // bodies' own tori (those contacts go through the sphere–sphere pass)
+    const SceneSDF&   sdf()        const { return sdf_; }
+
+private:
+    template <class F> void forRange(size_t count, size_t grain, F&& fn);
+
+    void collideSpheres(const PhysicsConfig& cfg);
+    void collideSDF(const PhysicsConfig& cfg, size_t begin, size_t end);
+
+    void setPosition       (size_t i, const glm::vec3& p) { x_[i]  = p.x; y_[i]  = p.y; z_[i]  = p.z; }
+    void setVelocity       (size_t i, const glm::vec3& v) { vx_[i] = v.x; vy_[i] = v.y; vz_[i] = v.z; }
+    glm::vec3 angularVelocity(size_t i) const { return glm::vec3(wx_[i], wy_[i], wz_[i]); }
+    void setAngularVelocity(size_t i, const glm::vec3& w) { wx_[i] = w.x; wy_[i] = w.y; wz_[i] = w.z; }
+
+    // Arrays whose padding lanes are zero (all but qw_ and ids_)
+    std::array<FloatArray*, 18> zeroPadded();
+    // Resize every array to hold `count` bodies plus inert padding
+    void resizeBodies(size_t count);
+
+    size_t     count_ = 0;
+    SlotMap    slots_;
+    DirtyRange dirty_, idsDirty_;
+
+    FloatArray x_, y_, z_;          // position
+    FloatArray vx_, vy_, vz_;       // linear velocity
+    FloatArray ax_, ay_, az_;       // gravitational acceleration (per substep)
+    FloatArray radius_, mass_, inertia_;
+    FloatArray qx_, qy_, qz_, qw_;  // orientation
+    FloatArray wx_, wy_, wz_;       // angular velocity
+    std::vector<unsigned> ids_;
+
+    const PhysicsKernels* kernels_;
+    JobSystem*            jobs_ = nullptr;
+    Gravity               gravity_;
+    Broadphase            broadphase_;
+    FrameArena            frame_;
+    SceneSDF              sdf_;
+};
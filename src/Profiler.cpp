@@ -0,0 +1,177 @@
+// Profiler.cpp
+#include "Profiler.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+struct Event {
+    const char* name;
+    uint32_t    track;
+    uint64_t    startNs, durNs;
+};
+
+// One per recording thread; the mutex is only contended during endFrame()
+struct ThreadBuffer {
+    std::mutex         mutex;
+    std::vector<Event> events;
+    uint32_t           track = 0;
+};
+
+struct Zone {
+    std::vector<float> samples;   // ms, ring of SAMPLE_WINDOW
+    size_t             next = 0;
+};
+
+struct State {
+    std::mutex                                 registryMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    // Main thread only (endFrame / stats / capture)
+    std::vector<Event>          drained;
+    std::map<std::string, Zone, std::less<>> zones;   // found by const char*, no temporaries
+    std::vector<Event>          capture;
+    bool                        capturing = false;
+    uint64_t                    epochNs   = 0;
+};
+
+State& state() {
+    static State s;
+    return s;
+}
+
+thread_local ThreadBuffer* tlsBuffer = nullptr;
+
+ThreadBuffer& localBuffer() {
+    if (!tlsBuffer) {
+        State& s = state();
+        std::lock_guard<std::mutex> lock(s.registryMutex);
+        s.buffers.push_back(std::make_unique<ThreadBuffer>());
+        tlsBuffer = s.buffers.back().get();
+        tlsBuffer->track = uint32_t(s.buffers.size() - 1);
+    }
+    return *tlsBuffer;
+}
+
+// JSON string body; zone names are plain literals, so escaping stays minimal
+void writeEscaped(std::ostream& out, const char* s) {
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') out << '\\';
+        out << *s;
+    }
+}
+
+} // namespace
+
+uint64_t Profiler::nowNs() {
+    return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+uint32_t Profiler::threadTrack() {
+    return localBuffer().track;
+}
+
+void Profiler::record(const char* name, uint32_t track, uint64_t startNs, uint64_t durNs) {
+    ThreadBuffer& b = localBuffer();
+    std::lock_guard<std::mutex> lock(b.mutex);
+    b.events.push_back(Event{ name, track, startNs, durNs });
+}
+
+void Profiler::endFrame() {
+    State& s = state();
+    s.drained.clear();
+    {
+        std::lock_guard<std::mutex> lock(s.registryMutex);
+        for (auto& b : s.buffers) {
+            std::lock_guard<std::mutex> bl(b->mutex);
+            s.drained.insert(s.drained.end(), b->events.begin(), b->events.end());
+            b->events.clear();
+        }
+    }
+    for (const Event& e : s.drained) {
+        auto it = s.zones.find(e.name);
+        if (it == s.zones.end()) it = s.zones.emplace(e.name, Zone{}).first;
+        Zone& z = it->second;
+        float ms = float(double(e.durNs) * 1e-6);
+        if (z.samples.size() < SAMPLE_WINDOW) z.samples.push_back(ms);
+        else                                  z.samples[z.next] = ms;
+        z.next = (z.next + 1) % SAMPLE_WINDOW;
+    }
+    if (s.capturing) s.capture.insert(s.capture.end(), s.drained.begin(), s.drained.end());
+}
+
+static ZoneStats summarize(const std::string& name, const std::vector<float>& samples) {
+    ZoneStats st;
+    st.name    = name;
+    st.samples = samples.size();
+    if (samples.empty()) return st;
+    std::vector<float> sorted = samples;
+    size_t k = std::min(sorted.size() - 1, sorted.size() * 99 / 100);
+    std::nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+    st.p99Ms = sorted[k];
+    double sum = 0.0;
+    float  mn  = samples[0];
+    for (float v : samples) { sum += v; mn = std::min(mn, v); }
+    st.minMs = mn;
+    st.avgMs = sum / double(samples.size());
+    return st;
+}
+
+std::vector<ZoneStats> Profiler::stats() {
+    std::vector<ZoneStats> out;
+    for (const auto& kv : state().zones) out.push_back(summarize(kv.first, kv.second.samples));
+    return out;
+}
+
+bool Profiler::zoneStats(const char* name, ZoneStats& out) {
+    const auto& zones = state().zones;
+    auto it = zones.find(name);
+    if (it == zones.end() || it->second.samples.empty()) return false;
+    out = summarize(it->first, it->second.samples);
+    return true;
+}
+
+void Profiler::beginCapture() {
+    State& s = state();
+    s.capture.clear();
+    s.capturing = true;
+    s.epochNs   = nowNs();
+}
+
+bool Profiler::capturing() {
+    return state().capturing;
+}
+
+bool Profiler::endCapture(const std::string& path) {
+    State& s = state();
+    s.capturing = false;
+
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Profiler: cannot write " << path << "\n";
+        return false;
+    }
+    out << std::fixed << std::setprecision(3);
+    out << "{\"traceEvents\":[\n";
+    out << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << GPU_TRACK
+        << ",\"args\":{\"name\":\"GPU\"}}";
+    for (const Event& e : s.capture) {
+        // Events may predate the capture by up to a frame; clamp to its start
+        double ts = e.startNs > s.epochNs ? double(e.startNs - s.epochNs) * 1e-3 : 0.0;
+        out << ",\n{\"name\":\"";
+        writeEscaped(out, e.name);
+        out << "\",\"ph\":\"X\",\"pid\":0,\"tid\":" << e.track
+            << ",\"ts\":" << ts << ",\"dur\":" << double(e.durNs) * 1e-3 << "}";
+    }
+    out << "\n]}\n";
+    std::cout << "Profiler: wrote " << s.capture.size() << " events to " << path << "\n";
+    s.capture.clear();
+    return bool(out);
+}
@@ -0,0 +1,74 @@
+// Profiler.hpp
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Zones are on in debug builds and compile to nothing in release, unless the
+// build defines METHARIZON_PROFILE explicitly (CMake option of the same name).
+#ifndef METHARIZON_PROFILE
+#  ifdef NDEBUG
+#    define METHARIZON_PROFILE 0
+#  else
+#    define METHARIZON_PROFILE 1
+#  endif
+#endif
+
+struct ZoneStats {
+    std::string name;
+    size_t      samples = 0;   // in the rolling window
+    double      minMs = 0, avgMs = 0, p99Ms = 0;
+};
+
+// Process-wide zone recorder. Threads append finished zones to their own
+// buffer; endFrame() (main thread, once per frame) drains the buffers into
+// per-zone rolling windows and, while capturing, into a Chrome trace.
+class Profiler {
+public:
+    // Track id of GPU zones in the trace; CPU threads count up from 0
+    static constexpr uint32_t GPU_TRACK = 1000;
+
+    static uint64_t nowNs();
+    static uint32_t threadTrack();
+
+    // `name` must outlive the profiler (string literals)
+    static void record(const char* name, uint32_t track, uint64_t startNs, uint64_t durNs);
+    static void endFrame();
+
+    // Rolling statistics over the last SAMPLE_WINDOW samples of each zone
+    static std::vector<ZoneStats> stats();
+    static bool zoneStats(const char* name, ZoneStats& out);
+
+    // Chrome trace (chrome://tracing, Perfetto): everything recorded between
+    // the two calls is written as complete ("X") events
+    static void beginCapture();
+    static bool endCapture(const std::string& path);
+    static bool capturing();
+
+    static constexpr size_t SAMPLE_WINDOW = 1024;
+};
+
+// RAII CPU zone; use through PROFILE_ZONE
+class ProfileZone {
+public:
+    explicit ProfileZone(const char* name) : name_(name), start_(Profiler::nowNs()) {}
+    ~ProfileZone() { Profiler::record(name_, Profiler::threadTrack(), start_, Profiler::nowNs() - start_); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* name_;
+    uint64_t    start_;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b)  PROFILE_CONCAT_(a, b)
+
+#if METHARIZON_PROFILE
+#  define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+#else
+#  define PROFILE_ZONE(name) ((void)0)
+#endif
@@ -1,7 +1,14 @@
 // Raymarcher.cpp
 #include "Raymarcher.hpp"
+#include "BrickMap.hpp"
+#include "PhysicsWorld.hpp"
+#include "SceneSDF.hpp"
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 
 // Utility: read a text file into a string
@@ -14,147 +21,444 @@ static std::string readFile(const char* path) {
 
 Raymarcher::Raymarcher() {}
 Raymarcher::~Raymarcher() {
-    if (_program)      glDeleteProgram(_program);
+    for (auto& kv : _variants)
+        if (kv.second.program) glDeleteProgram(kv.second.program);
+    for (auto& kv : _lightVariants)
+        if (kv.second.program) glDeleteProgram(kv.second.program);
     if (_vao)          glDeleteVertexArrays(1, &_vao);
-    if (_ssboPosMinor) glDeleteBuffers(1, &_ssboPosMinor);
-    if (_ssboIDs)      glDeleteBuffers(1, &_ssboIDs);
-    if (_ssboOrient)   glDeleteBuffers(1, &_ssboOrient);
+    if (_preFbo)       glDeleteFramebuffers(1, &_preFbo);
+    if (_preTex)       glDeleteTextures(1, &_preTex);
+    if (_sceneFbo)     glDeleteFramebuffers(1, &_sceneFbo);
+    if (_sceneTex)     glDeleteTextures(1, &_sceneTex);
+    if (_gFbo)         glDeleteFramebuffers(1, &_gFbo);
+    GLuint gTex[4] = { _gPosTex[0], _gPosTex[1], _gNormTex, _gIDTex };
+    glDeleteTextures(4, gTex);
+    GLuint brickTex[2] = { _brickIndexTex, _brickAtlasTex };
+    glDeleteTextures(2, brickTex);
+    for (int k = 0; k < STEP_STATS; ++k)
+        if (_stepFence[k]) glDeleteSync(_stepFence[k]);
+    if (_stepBuf[0]) glDeleteBuffers(STEP_STATS, _stepBuf);
 }
 
 bool Raymarcher::init() {
-    // --- Compile & link shaders ---
-    GLuint vs = loadShader("shaders/fullscreen.vert", GL_VERTEX_SHADER);
-    GLuint fs = loadShader("shaders/raymarch.frag",    GL_FRAGMENT_SHADER);
-    if (!vs || !fs) return false;
-    if (!linkProgram(vs, fs)) return false;
-    glDeleteShader(vs); glDeleteShader(fs);
-
-    // --- Get uniform locations ---
-    _locResolution  = glGetUniformLocation(_program, "u_resolution");
-    _locTime        = glGetUniformLocation(_program, "u_time");
-    _locMaxSteps    = glGetUniformLocation(_program, "u_maxSteps");
-    _locEpsilon     = glGetUniformLocation(_program, "u_epsilon");
-    _locPass        = glGetUniformLocation(_program, "u_pass");
-    _locMode        = glGetUniformLocation(_program, "u_mode");
-    _locObjInv      = glGetUniformLocation(_program, "u_objInvTransform");
-    _locCamPos      = glGetUniformLocation(_program, "u_camPos");
-    _locCamForward  = glGetUniformLocation(_program, "u_camForward");
-    _locCamRight    = glGetUniformLocation(_program, "u_camRight");
-    _locCamUp       = glGetUniformLocation(_program, "u_camUp");
-    _locSpawnCount  = glGetUniformLocation(_program, "u_spawnCount");
-
-    // --- Create SSBOs ---
-    glGenBuffers(1, &_ssboPosMinor);
-    glGenBuffers(1, &_ssboIDs);
-    glGenBuffers(1, &_ssboOrient);
+    // --- Load shader sources; variants are compiled (or fetched) on demand ---
+    _vertSource = readFile("shaders/fullscreen.vert");
+    _fragSource = readFile("shaders/raymarch.frag");
+    _lightSource = readFile("shaders/lighting.frag");
+    _baseSource  = "#define BASE_SHAPE 1\n" + SceneSDF::baseGLSL();
+    if (_vertSource.empty() || _fragSource.empty() || _lightSource.empty()) {
+        std::cerr << "Missing shaders/fullscreen.vert, raymarch.frag or lighting.frag\n";
+        return false;
+    }
+    // The generic variants double as a source check and as the fallback
+    if (!variant(RENDER_SHADED, true, 0) || !lightVariant(RENDER_SHADED)) return false;
 
     // --- Build VAO for a fullscreen triangle ---
     buildFullScreenTriangle();
     return true;
 }
 
-void Raymarcher::updateSpawns(const std::vector<glm::vec3>& positions,
-                              const std::vector<float>&     minors,
-                              const std::vector<unsigned>&   ids,
-                              const std::vector<glm::quat>&  orientations)
+// Insert #defines right after the #version line, which must stay first
+static std::string specialize(const std::string& src, const std::string& defines) {
+    size_t eol = src.compare(0, 8, "#version") == 0 ? src.find('\n') : std::string::npos;
+    if (eol == std::string::npos) return defines + src;
+    return src.substr(0, eol + 1) + defines + src.substr(eol + 1);
+}
+
+const Raymarcher::Variant* Raymarcher::variant(int mode, bool spawns, int maxSteps) {
+    maxSteps = std::max(maxSteps, 0);
+    const uint32_t key = uint32_t(mode & 0xFF) | (spawns ? 0x100u : 0u) | (uint32_t(maxSteps) << 9);
+    auto it = _variants.find(key);
+    if (it != _variants.end()) return it->second.program ? &it->second : nullptr;
+
+    // --- Build; a failed build is remembered so it is not retried each frame ---
+    char defines[128];
+    int len = std::snprintf(defines, sizeof defines, "#define MODE %d\n#define SPAWNS %d\n", mode, spawns ? 1 : 0);
+    if (maxSteps > 0)
+        std::snprintf(defines + len, sizeof defines - len, "#define MAX_STEPS %d\n", maxSteps);
+    char label[64];
+    std::snprintf(label, sizeof label, "raymarch mode %d spawns %d steps %d", mode, spawns ? 1 : 0, maxSteps);
+
+    Variant& v = _variants[key];
+    v.program = _shaderCache.build(_vertSource, specialize(_fragSource, defines + _baseSource), label);
+    if (!v.program) return nullptr;
+
+    // --- Get uniform locations ---
+    v.locResolution  = glGetUniformLocation(v.program, "u_resolution");
+    v.locTime        = glGetUniformLocation(v.program, "u_time");
+    v.locMaxSteps    = glGetUniformLocation(v.program, "u_maxSteps");
+    v.locEpsilon     = glGetUniformLocation(v.program, "u_epsilon");
+    v.locPass        = glGetUniformLocation(v.program, "u_pass");
+    v.locTile        = glGetUniformLocation(v.program, "u_tile");
+    v.locDepthTex    = glGetUniformLocation(v.program, "u_depthTex");
+    v.locObjInv      = glGetUniformLocation(v.program, "u_objInvTransform");
+    v.locCamPos      = glGetUniformLocation(v.program, "u_camPos");
+    v.locCamForward  = glGetUniformLocation(v.program, "u_camForward");
+    v.locCamRight    = glGetUniformLocation(v.program, "u_camRight");
+    v.locCamUp       = glGetUniformLocation(v.program, "u_camUp");
+    v.locSpawnCount  = glGetUniformLocation(v.program, "u_spawnCount");
+    v.locGridOrigin  = glGetUniformLocation(v.program, "u_gridOrigin");
+    v.locGridCell    = glGetUniformLocation(v.program, "u_gridCell");
+    v.locGridDims    = glGetUniformLocation(v.program, "u_gridDims");
+    v.locReproject      = glGetUniformLocation(v.program, "u_reproject");
+    v.locReprojBackoff  = glGetUniformLocation(v.program, "u_reprojBackoff");
+    v.locHistory        = glGetUniformLocation(v.program, "u_history");
+    v.locPrevResolution = glGetUniformLocation(v.program, "u_prevResolution");
+    v.locPrevCamPos     = glGetUniformLocation(v.program, "u_prevCamPos");
+    v.locPrevCamForward = glGetUniformLocation(v.program, "u_prevCamForward");
+    v.locPrevCamRight   = glGetUniformLocation(v.program, "u_prevCamRight");
+    v.locPrevCamUp      = glGetUniformLocation(v.program, "u_prevCamUp");
+    v.locBricks         = glGetUniformLocation(v.program, "u_bricks");
+    v.locBrickIndex     = glGetUniformLocation(v.program, "u_brickIndex");
+    v.locBrickAtlas     = glGetUniformLocation(v.program, "u_brickAtlas");
+    v.locBrickOrigin    = glGetUniformLocation(v.program, "u_brickOrigin");
+    v.locBrickCell      = glGetUniformLocation(v.program, "u_brickCell");
+    v.locBrickDims      = glGetUniformLocation(v.program, "u_brickDims");
+    v.locRelax          = glGetUniformLocation(v.program, "u_relax");
+    v.locConeEpsilon    = glGetUniformLocation(v.program, "u_coneEpsilon");
+    v.locBoundClip      = glGetUniformLocation(v.program, "u_boundClip");
+    v.locBound          = glGetUniformLocation(v.program, "u_bound");
+    v.locCountSteps     = glGetUniformLocation(v.program, "u_countSteps");
+    return &v;
+}
+
+const Raymarcher::LightVariant* Raymarcher::lightVariant(int mode) {
+    auto it = _lightVariants.find(mode);
+    if (it != _lightVariants.end()) return it->second.program ? &it->second : nullptr;
+
+    char defines[32], label[32];
+    std::snprintf(defines, sizeof defines, "#define MODE %d\n", mode);
+    std::snprintf(label, sizeof label, "lighting mode %d", mode);
+
+    LightVariant& v = _lightVariants[mode];
+    v.program = _shaderCache.build(_vertSource, specialize(_lightSource, defines), label);
+    if (!v.program) return nullptr;
+
+    v.locPosition = glGetUniformLocation(v.program, "u_gPosition");
+    v.locNormal   = glGetUniformLocation(v.program, "u_gNormal");
+    v.locID       = glGetUniformLocation(v.program, "u_gID");
+    return &v;
+}
+
+void Raymarcher::updateSpawns(const BodyView& bodies)
 {
-    size_t n = positions.size();
-    spawnPosMin.resize(n);
-    spawnIDs   .resize(n);
-    spawnOrient.resize(n);
-    for (size_t i = 0; i < n; ++i) {
-        spawnPosMin[i] = glm::vec4(positions[i], minors[i]);
-        spawnIDs   [i] = ids[i];
-        spawnOrient[i] = orientations[i];
+    PROFILE_ZONE("updateSpawns");
+    _frame.reset();
+    const size_t n = bodies.count;
+    const DirtyRange& dirty = bodies.dirty;
+    const DirtyRange& idsDirty = bodies.idsDirty;
+    _ssboPosMinor.invalidate(dirty.begin * sizeof(glm::vec4), dirty.end * sizeof(glm::vec4));
+    _ssboOrient  .invalidate(dirty.begin * sizeof(glm::vec4), dirty.end * sizeof(glm::vec4));
+    _ssboIDs     .invalidate(idsDirty.begin * sizeof(unsigned), idsDirty.end * sizeof(unsigned));
+
+    float*    pm = reinterpret_cast<float*>   (_ssboPosMinor.map(n * sizeof(glm::vec4)));
+    unsigned* id = reinterpret_cast<unsigned*>(_ssboIDs     .map(n * sizeof(unsigned)));
+    float*    qo = reinterpret_cast<float*>   (_ssboOrient  .map(n * sizeof(glm::vec4)));
+    if (!pm || !id || !qo) { _spawnCount = 0; return; }
+
+    // Only what this region has not seen yet, straight from the SoA arrays
+    // into write-combined memory, in order
+    const float *x = bodies.x, *y = bodies.y, *z = bodies.z, *r = bodies.radius;
+    const float *qx = bodies.qx, *qy = bodies.qy, *qz = bodies.qz, *qw = bodies.qw;
+    const size_t pb = _ssboPosMinor.pendingBegin() / sizeof(glm::vec4);
+    const size_t pe = std::min(n, _ssboPosMinor.pendingEnd() / sizeof(glm::vec4));
+    for (size_t i = pb; i < pe; ++i) {
+        pm[4*i+0] = x[i];  pm[4*i+1] = y[i];  pm[4*i+2] = z[i];  pm[4*i+3] = r[i];
+    }
+    const size_t ob = _ssboOrient.pendingBegin() / sizeof(glm::vec4);
+    const size_t oe = std::min(n, _ssboOrient.pendingEnd() / sizeof(glm::vec4));
+    for (size_t i = ob; i < oe; ++i) {
+        qo[4*i+0] = qx[i]; qo[4*i+1] = qy[i]; qo[4*i+2] = qz[i]; qo[4*i+3] = qw[i];
+    }
+    const size_t ib = _ssboIDs.pendingBegin() / sizeof(unsigned);
+    const size_t ie = std::min(n, _ssboIDs.pendingEnd() / sizeof(unsigned));
+    if (ib < ie) std::memcpy(id + ib, bodies.ids + ib, (ie - ib) * sizeof(unsigned));
+
+    // --- Torus grid, inflated by the smooth-min radius of map(); rebuilt
+    //     only when a body moved, appeared or disappeared ---
+    if (!dirty.empty() || n != _spawnCount) {
+        _grid.build(x, y, z, r, n, SceneSDF::BLEND_K, _frame);
+        _ssboCellStart.invalidate(0, _grid.cellStart().size() * sizeof(uint32_t));
+        _ssboCellItems.invalidate(0, _grid.items().size() * sizeof(uint32_t));
+    }
+    const std::vector<uint32_t>& start = _grid.cellStart();
+    const std::vector<uint32_t>& items = _grid.items();
+    uint8_t* cs = _ssboCellStart.map(start.size() * sizeof(uint32_t));
+    uint8_t* ci = _ssboCellItems.map(std::max<size_t>(items.size(), 1) * sizeof(uint32_t));
+    if (!cs || !ci) { _spawnCount = 0; return; }
+    if (_ssboCellStart.pendingBegin() < _ssboCellStart.pendingEnd())
+        std::memcpy(cs, start.data(), start.size() * sizeof(uint32_t));
+    if (_ssboCellItems.pendingBegin() < _ssboCellItems.pendingEnd())
+        std::memcpy(ci, items.data(), items.size() * sizeof(uint32_t));
+    _spawnCount = unsigned(n);
+}
+
+void Raymarcher::setBrickMap(const BrickMap* bricks) {
+    _bricks = bricks && !bricks->empty() && bricks->brickCount() > 0;
+    if (!_bricks) return;
+    PROFILE_ZONE("brick map upload");
+
+    // --- Cells: bound and brick + 1, fetched per texel ---
+    const glm::ivec3 dims = bricks->dims();
+    const size_t cells = bricks->coarse().size();
+    std::vector<float> cell(2 * cells);
+    for (size_t i = 0; i < cells; ++i) {
+        cell[2*i+0] = bricks->coarse()[i];
+        cell[2*i+1] = float(bricks->index()[i]);   // exact below 2^24 bricks
+    }
+    if (!_brickIndexTex) glGenTextures(1, &_brickIndexTex);
+    glBindTexture(GL_TEXTURE_3D, _brickIndexTex);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_RG32F, dims.x, dims.y, dims.z, 0, GL_RG, GL_FLOAT, cell.data());
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    // --- Atlas: bricks packed x, then y, then z in a near-cubic block ---
+    const int B = BrickMap::BRICK;
+    const int count = int(bricks->brickCount());
+    const int ax = int(std::ceil(std::cbrt(double(count))));
+    const int ay = std::min(ax, (count + ax - 1) / ax);
+    const int az = (count + ax * ay - 1) / (ax * ay);
+    if (!_brickAtlasTex) glGenTextures(1, &_brickAtlasTex);
+    glBindTexture(GL_TEXTURE_3D, _brickAtlasTex);
+    glTexImage3D(GL_TEXTURE_3D, 0, GL_R32F, ax * B, ay * B, az * B, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    for (int s = 0; s < count; ++s)
+        glTexSubImage3D(GL_TEXTURE_3D, 0, (s % ax) * B, (s / ax % ay) * B, (s / (ax * ay)) * B,
+                        B, B, B, GL_RED, GL_FLOAT, bricks->brick(size_t(s)));
+    glBindTexture(GL_TEXTURE_3D, 0);
+
+    _brickOrigin  = bricks->origin();
+    _brickCell    = bricks->cellSize();
+    _brickDims    = dims;
+    _historyValid = false;
+}
+
+glm::vec4 Raymarcher::sceneBound(const glm::mat4& objInv) const {
+    // --- Base: its object-space sphere under the scene transform; map()
+    //     evaluates it at objInv·p, so march space is objInv⁻¹ of that ---
+    glm::vec3 center(0.0f);
+    float     radius = SceneSDF::baseBound();
+    if (_bricks) {
+        const glm::vec3 size = glm::vec3(_brickDims) * _brickCell;
+        center = _brickOrigin + 0.5f * size;
+        radius = 0.5f * glm::length(size);
+    }
+    const glm::mat4 xf = glm::inverse(objInv);
+    center = glm::vec3(xf * glm::vec4(center, 1.0f));
+    radius *= std::max(glm::length(glm::vec3(xf[0])), std::max(glm::length(glm::vec3(xf[1])), glm::length(glm::vec3(xf[2]))));
+    // A smooth-min bulge reaches at most k/4 past either shape
+    radius += 0.25f * SceneSDF::BLEND_K;
+    if (_spawnCount == 0) return glm::vec4(center, radius);
+
+    // --- Union with the sphere around the torus grid (already inflated by k) ---
+    const glm::vec3 gsize = glm::vec3(_grid.dims()) * _grid.cellSize();
+    const glm::vec3 gc = _grid.origin() + 0.5f * gsize;
+    const float     gr = 0.5f * glm::length(gsize);
+    const float     d  = glm::length(gc - center);
+    if (d + gr <= radius) return glm::vec4(center, radius);
+    if (d + radius <= gr) return glm::vec4(gc, gr);
+    const float r = 0.5f * (d + radius + gr);
+    return glm::vec4(center + (gc - center) * ((r - radius) / d), r);
+}
+
+void Raymarcher::collectStepStats() {
+    if (!_stepBuf[0]) {
+        glGenBuffers(STEP_STATS, _stepBuf);
+        for (GLuint b : _stepBuf) {
+            glBindBuffer(GL_SHADER_STORAGE_BUFFER, b);
+            glBufferData(GL_SHADER_STORAGE_BUFFER, 2 * sizeof(uint32_t), nullptr, GL_DYNAMIC_READ);
+        }
+    }
+    // --- Finished frames, oldest first; stop at the first still in flight ---
+    for (int k = 0; k < STEP_STATS; ++k) {
+        const int b = (_stepHead + k) % STEP_STATS;
+        GLsync f = _stepFence[b];
+        if (!f) continue;
+        if (glClientWaitSync(f, 0, 0) == GL_TIMEOUT_EXPIRED) break;
+        glDeleteSync(f);
+        _stepFence[b] = nullptr;
+        uint32_t stats[2] = {};
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, _stepBuf[b]);
+        glGetBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, sizeof stats, stats);
+        if (stats[0]) _avgSteps = float(stats[1]) / float(stats[0]);
     }
+    // --- This frame counts into the oldest buffer, unless it is still busy ---
+    const int b = _stepHead;
+    if (_stepFence[b]) { glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0); return; }
+    const uint32_t zero = 0;
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _stepBuf[b]);
+    glClearBufferData(GL_SHADER_STORAGE_BUFFER, GL_R32UI, GL_RED_INTEGER, GL_UNSIGNED_INT, &zero);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, _stepBuf[b]);
 }
 
 void Raymarcher::render(const RaymarchConfig& cfg, int mode, const glm::mat4& objInv) {
-    glUseProgram(_program);
+    PROFILE_ZONE("render");
+    _gpuProfiler.collect();
+    // Specialized variant, or the generic one if it failed to build
+    const Variant* v = variant(mode, _spawnCount > 0, cfg.maxSteps);
+    if (!v) v = variant(RENDER_SHADED, true, 0);
+    if (!v) return;
+    const LightVariant* lv = lightVariant(mode);
+    if (!lv) lv = lightVariant(RENDER_SHADED);
+    if (!lv) return;
+
+    _dynRes.begin();
+    glUseProgram(v->program);
+
+    // --- Internal resolution for this frame ---
+    const int winW = int(cfg.resolution.x), winH = int(cfg.resolution.y);
+    const float scale = _dynRes.scale();
+    const int W = std::max(1, int(winW * scale + 0.5f));
+    const int H = std::max(1, int(winH * scale + 0.5f));
+    ensureSceneTarget(winW, winH);
+    ensureGBuffer(winW, winH);
 
     // --- Set uniforms ---
-    glUniform1i (_locMode,       mode);
-    glUniform2fv(_locResolution, 1, &cfg.resolution[0]);
-    glUniform1f (_locTime,       cfg.time);
-    glUniform1i (_locMaxSteps,   cfg.maxSteps);
-    glUniform1f (_locEpsilon,    cfg.epsilon);
-    glUniform1i (_locPass,       cfg.pass);
-    glUniformMatrix4fv(_locObjInv, 1, GL_FALSE, &objInv[0][0]);
-    glUniform3fv(_locCamPos,     1, &cfg.camPos[0]);
-    glUniform3fv(_locCamForward, 1, &cfg.camForward[0]);
-    glUniform3fv(_locCamRight,   1, &cfg.camRight[0]);
-    glUniform3fv(_locCamUp,      1, &cfg.camUp[0]);
-
-    // --- Upload spawn count ---
-    unsigned count = (unsigned)spawnPosMin.size();
-    glUniform1ui(_locSpawnCount, count);
-
-    // --- SSBO 0: positions + radii ---
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _ssboPosMinor);
-    glBufferData(GL_SHADER_STORAGE_BUFFER,
-                 count * sizeof(glm::vec4),
-                 spawnPosMin.data(),
-                 GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, _ssboPosMinor);
-
-    // --- SSBO 1: IDs ---
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _ssboIDs);
-    glBufferData(GL_SHADER_STORAGE_BUFFER,
-                 count * sizeof(unsigned),
-                 spawnIDs.data(),
-                 GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, _ssboIDs);
-
-    // --- SSBO 2: orientations (quaternions) ---
-    glBindBuffer(GL_SHADER_STORAGE_BUFFER, _ssboOrient);
-    glBufferData(GL_SHADER_STORAGE_BUFFER,
-                 count * sizeof(glm::quat),
-                 spawnOrient.data(),
-                 GL_DYNAMIC_DRAW);
-    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, _ssboOrient);
-
-    // --- Draw fullscreen triangle ---
+    glUniform2f (v->locResolution, float(W), float(H));
+    glUniform1f (v->locTime,       cfg.time);
+    glUniform1i (v->locMaxSteps,   cfg.maxSteps);
+    glUniform1f (v->locEpsilon,    cfg.epsilon);
+    glUniform1i (v->locDepthTex,   0);
+    glUniformMatrix4fv(v->locObjInv, 1, GL_FALSE, &objInv[0][0]);
+    glUniform3fv(v->locCamPos,     1, &cfg.camPos[0]);
+    glUniform3fv(v->locCamForward, 1, &cfg.camForward[0]);
+    glUniform3fv(v->locCamRight,   1, &cfg.camRight[0]);
+    glUniform3fv(v->locCamUp,      1, &cfg.camUp[0]);
+
+    // --- Spawn count & SSBO ranges written by updateSpawns ---
+    glUniform1ui(v->locSpawnCount, _spawnCount);
+    _ssboPosMinor.bind(GL_SHADER_STORAGE_BUFFER, 0, _spawnCount * sizeof(glm::vec4));
+    _ssboIDs     .bind(GL_SHADER_STORAGE_BUFFER, 1, _spawnCount * sizeof(unsigned));
+    _ssboOrient  .bind(GL_SHADER_STORAGE_BUFFER, 2, _spawnCount * sizeof(glm::vec4));
+    _ssboCellStart.bind(GL_SHADER_STORAGE_BUFFER, 3, _grid.cellStart().size() * sizeof(uint32_t));
+    _ssboCellItems.bind(GL_SHADER_STORAGE_BUFFER, 4, _grid.items().size() * sizeof(uint32_t));
+    glUniform3fv(v->locGridOrigin, 1, &_grid.origin()[0]);
+    glUniform1f (v->locGridCell,   _grid.cellSize());
+    glUniform3iv(v->locGridDims,   1, &_grid.dims()[0]);
+
+    // --- Temporal hint: last frame's G-buffer positions, if they still apply ---
+    _gCurrent ^= 1;
+    const bool reproject = cfg.reproject && _historyValid && objInv == _prevObjInv;
+    glUniform1i (v->locReproject,      reproject ? 1 : 0);
+    glUniform1f (v->locReprojBackoff,  cfg.reprojectBackoff);
+    glUniform1i (v->locHistory,        4);
+    glUniform2fv(v->locPrevResolution, 1, &_prevResolution[0]);
+    glUniform3fv(v->locPrevCamPos,     1, &_prevCamPos[0]);
+    glUniform3fv(v->locPrevCamForward, 1, &_prevCamForward[0]);
+    glUniform3fv(v->locPrevCamRight,   1, &_prevCamRight[0]);
+    glUniform3fv(v->locPrevCamUp,      1, &_prevCamUp[0]);
+    glActiveTexture(GL_TEXTURE4);
+    glBindTexture(GL_TEXTURE_2D, _gPosTex[_gCurrent ^ 1]);
+
+    // --- Base shape cache on units 5 (cells) and 6 (atlas) ---
+    glUniform1i (v->locBricks,      _bricks ? 1 : 0);
+    glUniform1i (v->locBrickIndex,  5);
+    glUniform1i (v->locBrickAtlas,  6);
+    glUniform3fv(v->locBrickOrigin, 1, &_brickOrigin[0]);
+    glUniform1f (v->locBrickCell,   _brickCell);
+    glUniform3iv(v->locBrickDims,   1, &_brickDims[0]);
+
+    // --- Tracing mode; step counting needs a free StepStats buffer ---
+    bool countSteps = cfg.countSteps;
+    if (countSteps) {
+        collectStepStats();
+        countSteps = !_stepFence[_stepHead];
+    }
+    const glm::vec4 bound = sceneBound(objInv);
+    glUniform1f (v->locRelax,       glm::clamp(cfg.relax, 1.0f, 1.99f));
+    glUniform1f (v->locConeEpsilon, std::max(cfg.coneEpsilon, 0.0f));
+    glUniform1i (v->locBoundClip,   cfg.boundClip ? 1 : 0);
+    glUniform4fv(v->locBound,       1, &bound[0]);
+    glUniform1i (v->locCountSteps,  countSteps ? 1 : 0);
+    glActiveTexture(GL_TEXTURE5);
+    glBindTexture(GL_TEXTURE_3D, _bricks ? _brickIndexTex : 0);
+    glActiveTexture(GL_TEXTURE6);
+    glBindTexture(GL_TEXTURE_3D, _bricks ? _brickAtlasTex : 0);
+    glActiveTexture(GL_TEXTURE0);
+
+    // --- Draw fullscreen triangle(s) ---
     glBindVertexArray(_vao);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
+    const int tile = cfg.preTile;
+    if (tile > 1) {
+        // Pass 1: one cone per tile into the R32F target
+        PROFILE_GPU_ZONE(_gpuProfiler, "pre-pass");
+        ensurePreTarget((W + tile - 1) / tile, (H + tile - 1) / tile);
+        glBindFramebuffer(GL_FRAMEBUFFER, _preFbo);
+        glViewport(0, 0, _preW, _preH);
+        glUniform1i(v->locPass, 1);
+        glUniform1i(v->locTile, tile);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
+    {
+        // Pass 2 (or the only pass): full resolution into the G-buffer; after
+        // a pre-pass, rays start at their tile's distance
+        PROFILE_GPU_ZONE(_gpuProfiler, "march");
+        glBindFramebuffer(GL_FRAMEBUFFER, _gFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _gPosTex[_gCurrent], 0);
+        glViewport(0, 0, W, H);
+        if (tile > 1) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, _preTex);
+            glUniform1i(v->locPass, 2);
+        } else {
+            glUniform1i(v->locPass, 0);
+            glUniform1i(v->locTile, 1);
+        }
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+        if (countSteps) {
+            glMemoryBarrier(GL_BUFFER_UPDATE_BARRIER_BIT);   // atomics → glGetBufferSubData
+            _stepFence[_stepHead] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            _stepHead = (_stepHead + 1) % STEP_STATS;
+        }
+    }
+    {
+        // Lighting: one G-buffer fetch per pixel, no map() evaluations
+        PROFILE_GPU_ZONE(_gpuProfiler, "lighting");
+        glBindFramebuffer(GL_FRAMEBUFFER, _sceneFbo);
+        glViewport(0, 0, W, H);
+        glUseProgram(lv->program);
+        glUniform1i(lv->locPosition, 1);
+        glUniform1i(lv->locNormal,   2);
+        glUniform1i(lv->locID,       3);
+        glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, _gPosTex[_gCurrent]);
+        glActiveTexture(GL_TEXTURE2); glBindTexture(GL_TEXTURE_2D, _gNormTex);
+        glActiveTexture(GL_TEXTURE3); glBindTexture(GL_TEXTURE_2D, _gIDTex);
+        glActiveTexture(GL_TEXTURE0);
+        glDrawArrays(GL_TRIANGLES, 0, 3);
+    }
     glBindVertexArray(0);
-}
-
-GLuint Raymarcher::loadShader(const char* path, GLenum type) {
-    auto src = readFile(path);
-    const char* ptr = src.c_str();
-    GLuint s = glCreateShader(type);
-    glShaderSource(s, 1, &ptr, nullptr);
-    glCompileShader(s);
-    GLint ok = GL_FALSE;
-    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
-    if (!ok) {
-        GLint len; glGetShaderiv(s, GL_INFO_LOG_LENGTH, &len);
-        std::string log(len, ' ');
-        glGetShaderInfoLog(s, len, nullptr, &log[0]);
-        std::cerr << "Compile error in " << path << ":\n" << log;
-        glDeleteShader(s);
-        return 0;
-    }
-    return s;
-}
 
-bool Raymarcher::linkProgram(GLuint vs, GLuint fs) {
-    _program = glCreateProgram();
-    glAttachShader(_program, vs);
-    glAttachShader(_program, fs);
-    glLinkProgram(_program);
-    GLint ok = GL_FALSE;
-    glGetProgramiv(_program, GL_LINK_STATUS, &ok);
-    if (!ok) {
-        GLint len; glGetProgramiv(_program, GL_INFO_LOG_LENGTH, &len);
-        std::string log(len, ' ');
-        glGetProgramInfoLog(_program, len, nullptr, &log[0]);
-        std::cerr << "Link error:\n" << log;
-        glDeleteProgram(_program);
-        _program = 0;
-        return false;
+    // --- Upscale to the window (or cfg.target) ---
+    {
+        PROFILE_GPU_ZONE(_gpuProfiler, "upscale");
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, _sceneFbo);
+        glBindFramebuffer(GL_DRAW_FRAMEBUFFER, cfg.target);
+        glBlitFramebuffer(0, 0, W, H, 0, 0, winW, winH, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        glViewport(0, 0, winW, winH);
     }
-    return true;
+    _dynRes.end();
+
+    // --- This frame's positions are the next one's history ---
+    _historyValid   = true;
+    _prevResolution = glm::vec2(float(W), float(H));
+    _prevCamPos     = cfg.camPos;
+    _prevCamForward = cfg.camForward;
+    _prevCamRight   = cfg.camRight;
+    _prevCamUp      = cfg.camUp;
+    _prevObjInv     = objInv;
+
+    // --- Regions are free for reuse once this draw retires ---
+    _ssboPosMinor.fence();
+    _ssboIDs     .fence();
+    _ssboOrient  .fence();
+    _ssboCellStart.fence();
+    _ssboCellItems.fence();
 }
 
 void Raymarcher::buildFullScreenTriangle() {
@@ -180,3 +484,86 @@ void Raymarcher::buildFullScreenTriangle() {
     glBindVertexArray(0);
     glDeleteBuffers(1, &vbo);
 }
+
+void Raymarcher::ensurePreTarget(int width, int height) {
+    if (_preFbo && width == _preW && height == _preH) return;
+    _preW = width;
+    _preH = height;
+
+    if (!_preTex) glGenTextures(1, &_preTex);
+    glBindTexture(GL_TEXTURE_2D, _preTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, width, height, 0, GL_RED, GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!_preFbo) {
+        glGenFramebuffers(1, &_preFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, _preFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _preTex, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Pre-pass framebuffer incomplete\n";
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+}
+
+void Raymarcher::ensureSceneTarget(int width, int height) {
+    if (_sceneFbo && width == _sceneW && height == _sceneH) return;
+    _sceneW = width;
+    _sceneH = height;
+
+    if (!_sceneTex) glGenTextures(1, &_sceneTex);
+    glBindTexture(GL_TEXTURE_2D, _sceneTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!_sceneFbo) {
+        glGenFramebuffers(1, &_sceneFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, _sceneFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _sceneTex, 0);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "Scene framebuffer incomplete\n";
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+}
+
+void Raymarcher::ensureGBuffer(int width, int height) {
+    if (_gFbo && width == _gW && height == _gH) return;
+    _gW = width;
+    _gH = height;
+    _historyValid = false;
+
+    // Only ever read with texelFetch, so no filtering
+    struct Attachment { GLuint* tex; GLenum internal, format, type; };
+    const Attachment att[4] = {
+        { &_gPosTex[0], GL_RGBA32F, GL_RGBA,        GL_FLOAT },
+        { &_gPosTex[1], GL_RGBA32F, GL_RGBA,        GL_FLOAT },
+        { &_gNormTex,   GL_RGBA16F, GL_RGBA,        GL_HALF_FLOAT },
+        { &_gIDTex,     GL_R32UI,   GL_RED_INTEGER, GL_UNSIGNED_INT },
+    };
+    for (const Attachment& a : att) {
+        if (!*a.tex) glGenTextures(1, a.tex);
+        glBindTexture(GL_TEXTURE_2D, *a.tex);
+        glTexImage2D(GL_TEXTURE_2D, 0, a.internal, width, height, 0, a.format, a.type, nullptr);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    }
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    if (!_gFbo) {
+        glGenFramebuffers(1, &_gFbo);
+        glBindFramebuffer(GL_FRAMEBUFFER, _gFbo);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, _gPosTex[_gCurrent], 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, _gNormTex, 0);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT2, GL_TEXTURE_2D, _gIDTex, 0);
+        const GLenum bufs[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1, GL_COLOR_ATTACHMENT2 };
+        glDrawBuffers(3, bufs);
+        if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+            std::cerr << "G-buffer framebuffer incomplete\n";
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
+}
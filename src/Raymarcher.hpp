@@ -5,14 +5,39 @@
 #include <glm/glm.hpp>
 #include <glm/mat4x4.hpp>
 #include <glm/gtc/quaternion.hpp>
-#include <vector>
+#include "DynamicResolution.hpp"
+#include "FrameArena.hpp"
+#include "GpuProfiler.hpp"
+#include "ShaderCache.hpp"
+#include "StreamBuffer.hpp"
+#include "TorusGrid.hpp"
+#include <string>
+#include <unordered_map>
+
+class BrickMap;
+struct BodyView;
+
+// Render modes; each one is compiled into its own shader variant (MODE define)
+enum RenderMode {
+    RENDER_STEPS   = 0,   // march step count heat map
+    RENDER_NORMALS = 1,   // surface normals as colour
+    RENDER_SHADED  = 2,   // lit surface
+};
 
 struct RaymarchConfig {
-    glm::vec2 resolution;
+    glm::vec2 resolution;   // window size; the scene renders at resolution · renderScale()
     float     time;
     int       maxSteps;
     float     epsilon;
-    int       pass;
+    int       preTile = 8;  // depth pre-pass tile edge in pixels (4 or 8); <= 1 = single pass
+    bool      reproject = true;        // start rays from last frame's reprojected hits
+    float     reprojectBackoff = 0.9f; // fraction of the reprojected distance to start at
+    // Enhanced sphere tracing; the defaults are the plain march
+    float     relax       = 1.0f;      // over-relaxation ω in [1, 2): step ω·dist, undone on overshoot
+    float     coneEpsilon = 0.0f;      // hit below max(epsilon, coneEpsilon pixels at t); 0 = fixed
+    bool      boundClip   = false;     // march only inside the scene's bounding sphere
+    bool      countSteps  = false;     // measure averageSteps() (two atomics per pixel)
+    GLuint    target      = 0;         // framebuffer the upscale blits into; 0 = the window
     glm::vec3 camPos, camForward, camRight, camUp;
 };
 
@@ -21,39 +46,136 @@ public:
     Raymarcher();
     ~Raymarcher();
 
-    // Initialize GL program, get uniforms, create SSBOs, build VAO
+    // Load shader sources, build the generic program variant, build VAO.
+    // Every raymarch variant gets baseShape() emitted from SceneSDF.
+    // (SSBO storage is allocated on the first updateSpawns)
     bool init();
 
-    // Render full-screen triangle; reads SSBOs and uniforms
+    // Render full-screen triangle; reads SSBOs and uniforms. With a pre-pass
+    // tile, a 1/preTile resolution cone march first stores a safe start
+    // distance per tile, and the full-res pass begins each ray there. With
+    // cfg.reproject, rays also start short of last frame's hit along them
+    // when it reprojects within a few pixels, but never inside the torus
+    // grid, where bodies may have moved since (see raymarch.frag). The
+    // march writes position, normal and id into a G-buffer; a separate
+    // lighting pass (shaders/lighting.frag) shades it.
     void render(const RaymarchConfig& cfg, int mode, const glm::mat4& objInv);
 
-    // Upload dynamic spawn lists: positions, radii, IDs, orientations
-    void updateSpawns(const std::vector<glm::vec3>& positions,
-                      const std::vector<float>&     minors,
-                      const std::vector<unsigned>&   ids,
-                      const std::vector<glm::quat>&  orientations);
+    // Write positions, radii, IDs and orientations straight into the mapped
+    // stream buffers and rebuild the torus grid; the next render() reads them.
+    // Only the view's dirty ranges (accumulated per ring region) are copied;
+    // for a PhysicsWorld, pass world.view() and call clearDirty() after.
+    // Called once per frame; it resets the frame arena.
+    void updateSpawns(const BodyView& bodies);
+
+    // Upload a baked BrickMap of the base shape: cell bounds and brick ids as
+    // an RG32F 3D texture, bricks into an R32F 3D atlas sampled trilinearly.
+    // map() then costs one lookup for the base; null (or an empty map)
+    // returns to the analytic shape.
+    void setBrickMap(const BrickMap* bricks);
+
+    // Scene renders offscreen at a scale chosen from GPU timer queries against
+    // dynamicResolution().config().budgetMs, then is blitted (bilinear) up
+    DynamicResolution&       dynamicResolution()       { return _dynRes; }
+    const DynamicResolution& dynamicResolution() const { return _dynRes; }
+
+    // Mean march steps per full-res pixel while cfg.countSteps is set, from
+    // the newest frame the GPU has finished (a few frames behind); 0 before
+    float averageSteps() const { return _avgSteps; }
+
+    const FrameArena& frameArena() const { return _frame; }
 
 private:
-    // Helpers for shader loading/linking & VAO setup
-    GLuint loadShader(const char* path, GLenum type);
-    bool   linkProgram(GLuint vs, GLuint fs);
+    // One linked specialization of raymarch.frag and its uniform locations
+    struct Variant {
+        GLuint program = 0;
+        GLint  locResolution, locTime, locMaxSteps, locEpsilon, locPass;
+        GLint  locObjInv, locTile, locDepthTex;
+        GLint  locCamPos, locCamForward, locCamRight, locCamUp;
+        GLint  locSpawnCount;
+        GLint  locGridOrigin, locGridCell, locGridDims;
+        GLint  locReproject, locReprojBackoff, locHistory, locPrevResolution;
+        GLint  locPrevCamPos, locPrevCamForward, locPrevCamRight, locPrevCamUp;
+        GLint  locBricks, locBrickIndex, locBrickAtlas, locBrickOrigin, locBrickCell, locBrickDims;
+        GLint  locRelax, locConeEpsilon, locBoundClip, locBound, locCountSteps;
+    };
+
+    // Variant for (mode, spawn loop on/off, compile-time step count; 0 =
+    // read u_maxSteps), built on first use
+    const Variant* variant(int mode, bool spawns, int maxSteps);
+
+    // One linked specialization of lighting.frag
+    struct LightVariant {
+        GLuint program = 0;
+        GLint  locPosition, locNormal, locID;
+    };
+    const LightVariant* lightVariant(int mode);
+
+    // Helpers for VAO & render target setup
     void   buildFullScreenTriangle();
+    void   ensurePreTarget(int width, int height);
+    void   ensureSceneTarget(int width, int height);
+    void   ensureGBuffer(int width, int height);
+
+    // March-space sphere around the base shape and the torus grid
+    glm::vec4 sceneBound(const glm::mat4& objInv) const;
+
+    // Read back finished StepStats, then bind a cleared one to slot 5
+    void   collectStepStats();
+
+    // Shader sources & program variants
+    std::string _vertSource, _fragSource, _lightSource;
+    std::string _baseSource;   // SceneSDF::baseGLSL(), prepended to raymarch.frag
+    ShaderCache _shaderCache;
+    std::unordered_map<uint32_t, Variant> _variants;
+    std::unordered_map<int, LightVariant> _lightVariants;
 
     // GL handles
-    GLuint _program = 0;
     GLuint _vao     = 0;
-    GLuint _ssboPosMinor = 0;
-    GLuint _ssboIDs      = 0;
-    GLuint _ssboOrient   = 0;
-
-    // Uniform locations
-    GLint _locResolution, _locTime, _locMaxSteps, _locEpsilon, _locPass;
-    GLint _locMode, _locObjInv;
-    GLint _locCamPos, _locCamForward, _locCamRight, _locCamUp;
-    GLint _locSpawnCount;
-
-    // CPU‐side staging buffers
-    std::vector<glm::vec4> spawnPosMin;  // xyz = pos, w = radius
-    std::vector<unsigned>  spawnIDs;
-    std::vector<glm::quat> spawnOrient;  // quaternion per instance
+    GLuint _preFbo  = 0;   // R32F tile depth target of the pre-pass
+    GLuint _preTex  = 0;
+    int    _preW = 0, _preH = 0;
+    GLuint _sceneFbo = 0;  // RGBA8 target, window-sized; frames use a corner of it
+    GLuint _sceneTex = 0;
+    int    _sceneW = 0, _sceneH = 0;
+    GLuint _gFbo     = 0;  // G-buffer, window-sized like the scene target
+    GLuint _gPosTex[2] = {};  // RGBA32F: hit position, t (-1 = miss); ping-pong
+    int    _gCurrent = 0;     // _gPosTex written this frame; the other is history
+    GLuint _gNormTex = 0;  // RGBA16F: normal, step fraction
+    GLuint _gIDTex   = 0;  // R32UI:   primitive id
+    int    _gW = 0, _gH = 0;
+
+    // What rendered the history: camera, internal resolution, scene transform
+    bool      _historyValid = false;
+    glm::vec2 _prevResolution{0.0f};
+    glm::vec3 _prevCamPos{0.0f}, _prevCamForward{0.0f}, _prevCamRight{0.0f}, _prevCamUp{0.0f};
+    glm::mat4 _prevObjInv{1.0f};
+
+    // Brick-map cache of the base shape, see setBrickMap
+    GLuint     _brickIndexTex = 0;   // RG32F: cell bound, brick + 1
+    GLuint     _brickAtlasTex = 0;   // R32F:  BRICK³ samples per brick
+    glm::vec3  _brickOrigin{0.0f};
+    float      _brickCell = 0.0f;
+    glm::ivec3 _brickDims{0};
+    bool       _bricks = false;
+
+    // StepStats SSBOs, one per frame in flight; read back once fenced
+    static constexpr int STEP_STATS = 3;
+    GLuint _stepBuf[STEP_STATS] = {};
+    GLsync _stepFence[STEP_STATS] = {};
+    int    _stepHead = 0;
+    float  _avgSteps = 0.0f;
+
+    // Persistent-mapped SSBO rings, one region per frame in flight
+    StreamBuffer _ssboPosMinor;  // vec4: xyz = pos, w = radius
+    StreamBuffer _ssboIDs;       // uint
+    StreamBuffer _ssboOrient;    // vec4 quaternion x,y,z,w
+    StreamBuffer _ssboCellStart; // uint prefix sums of the torus grid
+    StreamBuffer _ssboCellItems; // uint torus indices per cell
+    TorusGrid    _grid;
+    FrameArena   _frame;         // per-frame CPU scratch, reset by updateSpawns
+    unsigned     _spawnCount = 0;
+
+    DynamicResolution _dynRes;
+    GpuProfiler       _gpuProfiler;
 };
@@ -0,0 +1,332 @@
+// Recording.cpp
+#include "Recording.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+
+static constexpr char     FILE_MAGIC[4]  = { 'M', 'Z', 'R', 'C' };
+static constexpr char     CHUNK_MAGIC[4] = { 'M', 'Z', 'C', 'K' };
+static constexpr uint32_t FILE_VERSION   = 1;
+static constexpr uint32_t CHUNK_KEYFRAME = 1u << 0;
+
+// Dynamic channels per body, in file order
+enum Channel { CX, CY, CZ, CQX, CQY, CQZ, CQW, CVX, CVY, CVZ, CWX, CWY, CWZ, CHANNELS };
+
+struct FileHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t flags;      // RecordFlags
+    float    posStep, velStep;
+    uint32_t reserved;
+};
+
+struct ChunkHeader {
+    char       magic[4];
+    uint32_t   flags;    // CHUNK_KEYFRAME
+    uint32_t   bodies;
+    uint32_t   payloadBytes;
+    uint64_t   tick;
+    FrameInput input;
+};
+
+// --- Encoding helpers ---
+
+static float channelStep(int c, float posStep, float velStep) {
+    if (c <= CZ)  return posStep;
+    if (c <= CQW) return 1.0f / 32767.0f;
+    return velStep;
+}
+
+static uint32_t encodeWord(float v, float step, bool quantize) {
+    uint32_t w;
+    if (!quantize) { std::memcpy(&w, &v, sizeof w); return w; }
+    double q = std::nearbyint(double(v) / double(step));
+    q = q < -2147483647.0 ? -2147483647.0 : q > 2147483647.0 ? 2147483647.0 : q;
+    return uint32_t(int32_t(q));
+}
+
+static float decodeWord(uint32_t w, float step, bool quantize) {
+    if (quantize) return float(int32_t(w)) * step;
+    float v;
+    std::memcpy(&v, &w, sizeof v);
+    return v;
+}
+
+static uint32_t zigzag(int32_t v)    { return (uint32_t(v) << 1) ^ uint32_t(v >> 31); }
+static int32_t  unzigzag(uint32_t v) { return int32_t(v >> 1) ^ -int32_t(v & 1); }
+
+static void putVarint(std::vector<uint8_t>& out, uint32_t v) {
+    while (v >= 0x80) { out.push_back(uint8_t(v) | 0x80); v >>= 7; }
+    out.push_back(uint8_t(v));
+}
+
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint32_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 35 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        v |= uint32_t(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static void putBytes(std::vector<uint8_t>& out, const void* src, size_t bytes) {
+    const uint8_t* b = static_cast<const uint8_t*>(src);
+    out.insert(out.end(), b, b + bytes);
+}
+
+// --- Writer ---
+
+RecordingWriter::~RecordingWriter() {
+    close();
+}
+
+bool RecordingWriter::open(const std::string& path, const RecordingOptions& opt) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Cannot create recording " << path << "\n";
+        return false;
+    }
+    opt_ = opt;
+    opt_.keyframeInterval = std::max<uint32_t>(opt_.keyframeInterval, 1);
+    frames_ = 0;
+    ids_.clear();
+    prev_.clear();
+
+    FileHeader h{};
+    std::memcpy(h.magic, FILE_MAGIC, 4);
+    h.version = FILE_VERSION;
+    h.flags   = opt_.flags;
+    h.posStep = opt_.posStep;
+    h.velStep = opt_.velStep;
+    bytes_ = std::fwrite(&h, 1, sizeof h, file_);
+    return bytes_ == sizeof h;
+}
+
+bool RecordingWriter::append(const PhysicsWorld& world, uint64_t tick, const FrameInput& input) {
+    if (!file_) return false;
+    const size_t n = world.size();
+    const bool quantize = (opt_.flags & RECORD_QUANTIZE) != 0;
+
+    // --- Encode the dynamic channels, channel-major ---
+    const float* src[CHANNELS] = { world.x(), world.y(), world.z(),
+                                   world.qx(), world.qy(), world.qz(), world.qw(),
+                                   world.vx(), world.vy(), world.vz(),
+                                   world.wx(), world.wy(), world.wz() };
+    words_.resize(n * CHANNELS);
+    for (int c = 0; c < CHANNELS; ++c) {
+        const float step = channelStep(c, opt_.posStep, opt_.velStep);
+        for (size_t i = 0; i < n; ++i) words_[c * n + i] = encodeWord(src[c][i], step, quantize);
+    }
+
+    // --- Delta against the previous frame while the bodies stay the same ---
+    const bool delta = (opt_.flags & RECORD_DELTA) && frames_ > 0 &&
+                       sinceKey_ + 1 < opt_.keyframeInterval && ids_.size() == n &&
+                       std::memcmp(ids_.data(), world.ids(), n * sizeof(uint32_t)) == 0;
+    payload_.clear();
+    if (delta) {
+        for (size_t k = 0; k < words_.size(); ++k)
+            putVarint(payload_, quantize ? zigzag(int32_t(words_[k] - prev_[k])) : words_[k] ^ prev_[k]);
+        ++sinceKey_;
+    } else {
+        putBytes(payload_, world.ids(),      n * sizeof(uint32_t));
+        putBytes(payload_, world.radii(),    n * sizeof(float));
+        putBytes(payload_, world.masses(),   n * sizeof(float));
+        putBytes(payload_, world.inertias(), n * sizeof(float));
+        for (uint32_t w : words_) {
+            if (quantize) putVarint(payload_, zigzag(int32_t(w)));
+            else          putBytes(payload_, &w, sizeof w);
+        }
+        ids_.assign(world.ids(), world.ids() + n);
+        sinceKey_ = 0;
+    }
+    prev_.swap(words_);
+
+    ChunkHeader h{};
+    std::memcpy(h.magic, CHUNK_MAGIC, 4);
+    h.flags        = delta ? 0u : CHUNK_KEYFRAME;
+    h.bodies       = uint32_t(n);
+    h.payloadBytes = uint32_t(payload_.size());
+    h.tick         = tick;
+    h.input        = input;
+    bool ok = std::fwrite(&h, 1, sizeof h, file_) == sizeof h &&
+              std::fwrite(payload_.data(), 1, payload_.size(), file_) == payload_.size();
+    if (!ok) {
+        std::cerr << "Recording write failed\n";
+        return false;
+    }
+    bytes_ += sizeof h + payload_.size();
+    ++frames_;
+    return true;
+}
+
+bool RecordingWriter::close() {
+    if (!file_) return true;
+    bool ok = std::fclose(file_) == 0;
+    file_ = nullptr;
+    return ok;
+}
+
+// --- Frame ---
+
+BodyView RecordedFrame::view() const {
+    const size_t n = size();
+    BodyView v{ x.data(), y.data(), z.data(), radius.data(),
+                qx.data(), qy.data(), qz.data(), qw.data(), ids.data(), n, {}, {} };
+    v.dirty.add(0, n);
+    if (idsChanged) v.idsDirty.add(0, n);
+    return v;
+}
+
+std::vector<BodyDesc> RecordedFrame::bodies() const {
+    std::vector<BodyDesc> out(size());
+    for (size_t i = 0; i < out.size(); ++i) {
+        BodyDesc& b = out[i];
+        b.pos     = glm::vec3(x[i], y[i], z[i]);
+        b.radius  = radius[i];
+        b.mass    = mass[i];
+        b.inertia = inertia[i];
+        b.vel     = glm::vec3(vx[i], vy[i], vz[i]);
+        b.orient  = glm::quat(qw[i], qx[i], qy[i], qz[i]);
+        b.angVel  = glm::vec3(wx[i], wy[i], wz[i]);
+    }
+    return out;
+}
+
+// --- Reader ---
+
+RecordingReader::~RecordingReader() {
+    close();
+}
+
+bool RecordingReader::open(const std::string& path) {
+    close();
+
+    // --- Map the whole file read-only ---
+    if (!file_.open(path)) {
+        std::cerr << "Cannot map recording " << path << "\n";
+        return false;
+    }
+    data_ = file_.data();
+    size_ = file_.size();
+
+    FileHeader fh;
+    if (size_ < sizeof fh) { std::cerr << "Recording " << path << " is truncated\n"; close(); return false; }
+    std::memcpy(&fh, data_, sizeof fh);
+    if (std::memcmp(fh.magic, FILE_MAGIC, 4) != 0 || fh.version != FILE_VERSION) {
+        std::cerr << "Recording " << path << " has an unknown format\n";
+        close();
+        return false;
+    }
+    flags_   = fh.flags;
+    posStep_ = fh.posStep;
+    velStep_ = fh.velStep;
+
+    // --- Index the chunks; a torn tail (e.g. after a crash) ends the list ---
+    size_t off = sizeof fh, key = size_t(-1);
+    while (off + sizeof(ChunkHeader) <= size_) {
+        ChunkHeader h;
+        std::memcpy(&h, data_ + off, sizeof h);
+        if (std::memcmp(h.magic, CHUNK_MAGIC, 4) != 0 || h.payloadBytes > size_ - off - sizeof h) break;
+        if (h.flags & CHUNK_KEYFRAME) key = chunks_.size();
+        if (key == size_t(-1)) break;
+        chunks_.push_back(off);
+        keyframe_.push_back(key);
+        off += sizeof h + h.payloadBytes;
+    }
+    if (off != size_)
+        std::cerr << "Recording " << path << ": ignoring " << size_ - off << " trailing bytes\n";
+    return true;
+}
+
+void RecordingReader::close() {
+    file_.close();
+    data_ = nullptr;
+    size_ = 0;
+    chunks_.clear();
+    keyframe_.clear();
+    current_ = size_t(-1);
+    words_.clear();
+    frame_ = RecordedFrame{};
+}
+
+bool RecordingReader::seek(size_t k) {
+    if (k >= chunks_.size()) return false;
+    if (k == current_) { frame_.idsChanged = false; return true; }
+
+    // --- Apply deltas from the current frame, or start over at the keyframe ---
+    size_t from = (current_ != size_t(-1) && current_ < k && keyframe_[k] <= current_) ? current_ + 1
+                                                                                        : keyframe_[k];
+    frame_.idsChanged = current_ == size_t(-1);
+    for (size_t j = from; j <= k; ++j) {
+        if (!decode(j)) {
+            std::cerr << "Recording: frame " << j << " is corrupt\n";
+            current_ = size_t(-1);
+            return false;
+        }
+    }
+    current_ = k;
+
+    // --- Expand the channels ---
+    const bool quantize = (flags_ & RECORD_QUANTIZE) != 0;
+    const size_t n = frame_.ids.size();
+    std::vector<float>* dst[CHANNELS] = { &frame_.x, &frame_.y, &frame_.z,
+                                          &frame_.qx, &frame_.qy, &frame_.qz, &frame_.qw,
+                                          &frame_.vx, &frame_.vy, &frame_.vz,
+                                          &frame_.wx, &frame_.wy, &frame_.wz };
+    for (int c = 0; c < CHANNELS; ++c) {
+        const float step = channelStep(c, posStep_, velStep_);
+        dst[c]->resize(n);
+        for (size_t i = 0; i < n; ++i) (*dst[c])[i] = decodeWord(words_[c * n + i], step, quantize);
+    }
+    return true;
+}
+
+bool RecordingReader::decode(size_t k) {
+    ChunkHeader h;
+    std::memcpy(&h, data_ + chunks_[k], sizeof h);
+    const uint8_t* p   = data_ + chunks_[k] + sizeof h;
+    const uint8_t* end = p + h.payloadBytes;
+    const size_t   n   = h.bodies;
+    const bool quantize = (flags_ & RECORD_QUANTIZE) != 0;
+
+    if (h.flags & CHUNK_KEYFRAME) {
+        // --- Static data, then every channel in full ---
+        if (size_t(end - p) < n * 16) return false;
+        if (frame_.ids.size() != n || std::memcmp(frame_.ids.data(), p, n * sizeof(uint32_t)) != 0)
+            frame_.idsChanged = true;
+        frame_.ids.resize(n);
+        std::memcpy(frame_.ids.data(), p, n * sizeof(uint32_t));
+        p += n * sizeof(uint32_t);
+        for (std::vector<float>* v : { &frame_.radius, &frame_.mass, &frame_.inertia }) {
+            v->resize(n);
+            std::memcpy(v->data(), p, n * sizeof(float));
+            p += n * sizeof(float);
+        }
+        words_.resize(n * CHANNELS);
+        for (uint32_t& w : words_) {
+            if (quantize) {
+                uint32_t v;
+                if (!getVarint(p, end, v)) return false;
+                w = uint32_t(unzigzag(v));
+            } else {
+                if (end - p < 4) return false;
+                std::memcpy(&w, p, sizeof w);
+                p += sizeof w;
+            }
+        }
+    } else {
+        // --- Changes against the frame before ---
+        if (n != frame_.ids.size() || words_.size() != n * CHANNELS) return false;
+        for (uint32_t& w : words_) {
+            uint32_t v;
+            if (!getVarint(p, end, v)) return false;
+            w = quantize ? w + uint32_t(unzigzag(v)) : w ^ v;
+        }
+    }
+    frame_.tick  = h.tick;
+    frame_.input = h.input;
+    return true;
+}
@@ -0,0 +1,120 @@
+// Recording.hpp
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "MappedFile.hpp"
+#include "PhysicsWorld.hpp"
+
+// Per-frame input stored next to the body state: the raw deltas that drove
+// the frame and the camera they produced, so a replay needs neither
+struct FrameInput {
+    float    dt      = 0.0f;
+    int32_t  mouseDX = 0, mouseDY = 0;
+    uint32_t keys    = 0;            // application-defined key bits
+    int32_t  mode    = 0;            // render mode
+    float    camPos[3] = {};
+    float    camOri[4] = { 0.0f, 0.0f, 0.0f, 1.0f };   // x, y, z, w
+};
+
+enum RecordFlags : uint32_t {
+    RECORD_DELTA    = 1u << 0,  // frames between keyframes store varint changes
+    RECORD_QUANTIZE = 1u << 1,  // fixed-point positions, velocities and quaternions
+};
+
+struct RecordingOptions {
+    uint32_t flags            = 0;
+    uint32_t keyframeInterval = 120;            // with RECORD_DELTA: a full frame at least this often
+    float    posStep          = 1.0f / 4096.0f; // with RECORD_QUANTIZE: position resolution
+    float    velStep          = 1.0f / 1024.0f; //   and (angular) velocity resolution
+};
+
+// Appends one chunk per frame: a header with the tick and FrameInput, then
+// the bodies in SoA order. A keyframe holds ids, radii, masses and inertias
+// plus every dynamic channel; a delta frame (same ids as the one before)
+// holds only the changes of the dynamic channels, varint coded. Delta coding
+// pays off mostly together with quantization.
+class RecordingWriter {
+public:
+    RecordingWriter() = default;
+    ~RecordingWriter();
+
+    RecordingWriter(const RecordingWriter&) = delete;
+    RecordingWriter& operator=(const RecordingWriter&) = delete;
+
+    bool open(const std::string& path, const RecordingOptions& opt = {});
+    bool isOpen() const { return file_ != nullptr; }
+
+    // Append the world's bodies and this frame's input as one chunk
+    bool append(const PhysicsWorld& world, uint64_t tick, const FrameInput& input);
+
+    bool close();
+
+    uint64_t frames() const { return frames_; }
+    uint64_t bytes()  const { return bytes_; }
+
+private:
+    FILE*                 file_ = nullptr;
+    RecordingOptions      opt_;
+    uint64_t              frames_ = 0, bytes_ = 0;
+    uint32_t              sinceKey_ = 0;
+    std::vector<uint32_t> ids_;            // ids of the previous frame
+    std::vector<uint32_t> words_, prev_;   // dynamic channels, encoded, channel-major
+    std::vector<uint8_t>  payload_;
+};
+
+// One decoded frame, SoA
+struct RecordedFrame {
+    uint64_t   tick = 0;
+    FrameInput input;
+    bool       idsChanged = true;   // ids or static data differ from the previous frame read
+
+    std::vector<uint32_t> ids;
+    std::vector<float>    radius, mass, inertia;
+    std::vector<float>    x, y, z, qx, qy, qz, qw, vx, vy, vz, wx, wy, wz;
+
+    size_t size() const { return ids.size(); }
+
+    // Every body dirty; ids only when they changed
+    BodyView view() const;
+
+    // The bodies with their full state, e.g. to seed a PhysicsWorld
+    std::vector<BodyDesc> bodies() const;
+};
+
+// Memory-maps a recording and decodes frames on demand. Reading frames in
+// order only applies each delta; seeking decodes from the nearest keyframe.
+class RecordingReader {
+public:
+    RecordingReader() = default;
+    ~RecordingReader();
+
+    RecordingReader(const RecordingReader&) = delete;
+    RecordingReader& operator=(const RecordingReader&) = delete;
+
+    // Map the file and index its chunks; false on a missing or corrupt file
+    bool open(const std::string& path);
+    void close();
+
+    size_t frameCount() const { return chunks_.size(); }
+
+    // Decode frame k into frame(); false past the end or on a corrupt chunk
+    bool seek(size_t k);
+    const RecordedFrame& frame() const { return frame_; }
+
+private:
+    bool decode(size_t k);
+
+    MappedFile            file_;
+    const uint8_t*        data_ = nullptr;      // file_'s bytes
+    size_t                size_ = 0;
+    uint32_t              flags_ = 0;
+    float                 posStep_ = 0.0f, velStep_ = 0.0f;
+    std::vector<size_t>   chunks_;      // offset of each chunk header
+    std::vector<size_t>   keyframe_;    // keyframe each frame decodes from
+    size_t                current_ = size_t(-1);
+    std::vector<uint32_t> words_;       // dynamic channels of frame_, encoded
+    RecordedFrame         frame_;
+};
@@ -0,0 +1,147 @@
+// SceneFile.cpp
+#include "SceneFile.hpp"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+static constexpr char     SCENE_MAGIC[4] = { 'M', 'Z', 'S', 'C' };
+static constexpr uint32_t SCENE_VERSION  = 1;
+static constexpr uint32_t ORDER_MARK     = 0x01020304u;   // reads back differently on a big-endian host
+static constexpr size_t   SECTION_ALIGN  = 64;
+
+// Section ids, in file order; values are part of the format
+enum SceneSection : uint32_t {
+    SEC_X, SEC_Y, SEC_Z, SEC_RADIUS, SEC_MASS, SEC_INERTIA,
+    SEC_QX, SEC_QY, SEC_QZ, SEC_QW,
+    SEC_VX, SEC_VY, SEC_VZ, SEC_WX, SEC_WY, SEC_WZ,
+    SEC_IDS, SECTIONS
+};
+
+struct SceneHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t sections;     // entries in the table after the header
+    uint64_t bodies;
+    uint64_t stride;       // entries per section: bodies padded to SIMD_WIDTH
+    float    sdfXform[16]; // column-major
+};
+
+struct SectionEntry {
+    uint32_t id;           // SceneSection
+    uint32_t elementBytes; // 4 for every section of version 1
+    uint64_t offset;       // from the start of the file, SECTION_ALIGN aligned
+    uint64_t bytes;        // stride · elementBytes
+};
+
+static_assert(sizeof(SceneHeader) == 96 && sizeof(SectionEntry) == 24, "scene layout is part of the format");
+
+static bool littleEndianHost() {
+    const uint32_t probe = 1;
+    uint8_t first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+bool saveScene(const std::string& path, const PhysicsWorld& world, const glm::mat4& sdfXform) {
+    if (!littleEndianHost()) {
+        std::cerr << "Scenes are little-endian; cannot save " << path << " on this host\n";
+        return false;
+    }
+    const void* channels[SECTIONS] = {
+        world.x(), world.y(), world.z(), world.radii(), world.masses(), world.inertias(),
+        world.qx(), world.qy(), world.qz(), world.qw(),
+        world.vx(), world.vy(), world.vz(), world.wx(), world.wy(), world.wz(),
+        world.ids(),
+    };
+
+    SceneHeader h{};
+    std::memcpy(h.magic, SCENE_MAGIC, 4);
+    h.version   = SCENE_VERSION;
+    h.byteOrder = ORDER_MARK;
+    h.sections  = SECTIONS;
+    h.bodies    = world.size();
+    h.stride    = world.paddedSize();
+    std::memcpy(h.sdfXform, &sdfXform[0][0], sizeof h.sdfXform);
+
+    SectionEntry table[SECTIONS];
+    uint64_t off = sizeof h + sizeof table;
+    for (uint32_t s = 0; s < SECTIONS; ++s) {
+        off = (off + SECTION_ALIGN - 1) / SECTION_ALIGN * SECTION_ALIGN;
+        table[s] = SectionEntry{ s, 4, off, h.stride * 4 };
+        off += table[s].bytes;
+    }
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        std::cerr << "Cannot create scene " << path << "\n";
+        return false;
+    }
+    static const uint8_t zeros[SECTION_ALIGN] = {};
+    bool ok = std::fwrite(&h, sizeof h, 1, f) == 1 && std::fwrite(table, sizeof table, 1, f) == 1;
+    uint64_t at = sizeof h + sizeof table;
+    for (uint32_t s = 0; s < SECTIONS && ok; ++s) {
+        ok = std::fwrite(zeros, 1, size_t(table[s].offset - at), f) == table[s].offset - at &&
+             std::fwrite(channels[s], 1, size_t(table[s].bytes), f) == table[s].bytes;
+        at = table[s].offset + table[s].bytes;
+    }
+    ok = std::fclose(f) == 0 && ok;
+    if (!ok) std::cerr << "Cannot write scene " << path << "\n";
+    return ok;
+}
+
+bool SceneReader::open(const std::string& path) {
+    close();
+    if (!file_.open(path)) {
+        std::cerr << "Cannot map scene " << path << "\n";
+        return false;
+    }
+    const uint8_t* data = file_.data();
+    const size_t   size = file_.size();
+    auto fail = [&](const char* why) {
+        std::cerr << "Scene " << path << ": " << why << "\n";
+        close();
+        return false;
+    };
+
+    SceneHeader h;
+    if (size < sizeof h) return fail("truncated header");
+    std::memcpy(&h, data, sizeof h);
+    if (std::memcmp(h.magic, SCENE_MAGIC, 4) != 0 || h.version != SCENE_VERSION) return fail("unknown format");
+    if (h.byteOrder != ORDER_MARK) return fail("byte order differs from this host");
+    if (h.bodies > SlotMap::MAX_SLOTS || h.stride < h.bodies) return fail("bad body count");
+    if (h.sections > (size - sizeof h) / sizeof(SectionEntry)) return fail("truncated section table");
+
+    // --- Point each known section into the mapping ---
+    const void* found[SECTIONS] = {};
+    for (uint32_t k = 0; k < h.sections; ++k) {
+        SectionEntry e;
+        std::memcpy(&e, data + sizeof h + k * sizeof e, sizeof e);
+        if (e.id >= SECTIONS) continue;
+        if (e.elementBytes != 4 || e.offset % SECTION_ALIGN != 0 || e.bytes / 4 < h.bodies ||
+            e.offset > size || e.bytes > size - e.offset)
+            return fail("bad section");
+        found[e.id] = data + e.offset;
+    }
+    for (uint32_t s : { SEC_X, SEC_Y, SEC_Z, SEC_RADIUS, SEC_MASS, SEC_QX, SEC_QY, SEC_QZ, SEC_QW, SEC_IDS })
+        if (!found[s]) return fail("missing a required section");
+
+    auto f = [&](SceneSection s) { return static_cast<const float*>(found[s]); };
+    arrays_.x  = f(SEC_X);  arrays_.y  = f(SEC_Y);  arrays_.z  = f(SEC_Z);
+    arrays_.radius  = f(SEC_RADIUS);
+    arrays_.mass    = f(SEC_MASS);
+    arrays_.inertia = f(SEC_INERTIA);
+    arrays_.qx = f(SEC_QX); arrays_.qy = f(SEC_QY); arrays_.qz = f(SEC_QZ); arrays_.qw = f(SEC_QW);
+    arrays_.vx = f(SEC_VX); arrays_.vy = f(SEC_VY); arrays_.vz = f(SEC_VZ);
+    arrays_.wx = f(SEC_WX); arrays_.wy = f(SEC_WY); arrays_.wz = f(SEC_WZ);
+    arrays_.ids   = static_cast<const unsigned*>(found[SEC_IDS]);
+    arrays_.count = size_t(h.bodies);
+    std::memcpy(&sdfXform_[0][0], h.sdfXform, sizeof h.sdfXform);
+    return true;
+}
+
+void SceneReader::close() {
+    file_.close();
+    arrays_   = BodyArrays{};
+    sdfXform_ = glm::mat4(1.0f);
+}
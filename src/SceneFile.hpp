@@ -0,0 +1,41 @@
+// SceneFile.hpp
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <string>
+#include "MappedFile.hpp"
+#include "PhysicsWorld.hpp"
+
+// Binary scene (.mzs), little-endian: a header with the body count and the
+// static SDF's transform, a section table, then one section per body
+// channel. Sections start on 64-byte boundaries and hold the channel exactly
+// as PhysicsWorld stores it, padded to SIMD_WIDTH with inert lanes, so
+// loading maps the file and copies whole arrays; nothing is parsed per body.
+// Positions, radii, masses, orientations and ids are required; inertia,
+// velocity and spin are optional, and unknown sections are skipped.
+
+// Write the world's bodies and `sdfXform`; false (reported) on an I/O error
+bool saveScene(const std::string& path, const PhysicsWorld& world, const glm::mat4& sdfXform);
+
+// Maps a scene; arrays() points straight into the mapping
+class SceneReader {
+public:
+    SceneReader() = default;
+
+    SceneReader(const SceneReader&) = delete;
+    SceneReader& operator=(const SceneReader&) = delete;
+
+    // Map and validate the file; false (reported) if it is missing or corrupt
+    bool open(const std::string& path);
+    void close();
+
+    size_t            size()     const { return arrays_.count; }
+    const BodyArrays& arrays()   const { return arrays_; }   // for PhysicsWorld::assign
+    const glm::mat4&  sdfXform() const { return sdfXform_; }
+
+private:
+    MappedFile file_;
+    BodyArrays arrays_{};
+    glm::mat4  sdfXform_{1.0f};
+};
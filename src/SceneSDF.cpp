@@ -0,0 +1,110 @@
+// SceneSDF.cpp
+#include "SceneSDF.hpp"
+#include "BrickMap.hpp"
+#include <algorithm>
+#include <cmath>
+
+void SceneSDF::setTransform(const glm::mat4& xform) {
+    inv_ = glm::inverse(xform);
+}
+
+void SceneSDF::setTori(const float* x, const float* y, const float* z, const float* r,
+                       const float* qx, const float* qy, const float* qz, const float* qw, size_t count) {
+    tori_.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+        Torus& t = tori_[i];
+        t.center = glm::vec3(inv_ * glm::vec4(x[i], y[i], z[i], 1.0f));
+        t.major  = r[i];
+        t.minor  = r[i] * 0.4f;
+        t.q      = glm::quat(qw[i], qx[i], qy[i], qz[i]);
+    }
+}
+
+void SceneSDF::evaluate(const float* px, const float* py, const float* pz, size_t count,
+                        float* dist, float* gx, float* gy, float* gz) const {
+    const bool grad = gx && gy && gz;
+    // inv_ split into its linear part M and translation; op = M·p + t
+    const glm::vec4 c0 = inv_[0], c1 = inv_[1], c2 = inv_[2], c3 = inv_[3];
+
+    alignas(64) float ox[BATCH], oy[BATCH], oz[BATCH];
+    alignas(64) float d[BATCH], dx[BATCH], dy[BATCH], dz[BATCH];
+
+    for (size_t base = 0; base < count; base += BATCH) {
+        const size_t n = std::min(BATCH, count - base);
+
+        // --- Base shape in object space, or one cache lookup ---
+        for (size_t i = 0; i < n; ++i) {
+            float x = px[base + i], y = py[base + i], z = pz[base + i];
+            ox[i] = c0.x * x + c1.x * y + c2.x * z + c3.x;
+            oy[i] = c0.y * x + c1.y * y + c2.y * z + c3.y;
+            oz[i] = c0.z * x + c1.z * y + c2.z * z + c3.z;
+            if (cache_) continue;
+            glm::vec3 g;
+            d[i]  = baseShape().distance(glm::vec3(ox[i], oy[i], oz[i]), &g);
+            dx[i] = g.x;
+            dy[i] = g.y;
+            dz[i] = g.z;
+        }
+        if (cache_) cache_->sample(ox, oy, oz, n, d, dx, dy, dz);
+
+        // --- Smooth-min each torus into the running distance ---
+        for (const Torus& t : tori_) {
+            const float qx = t.q.x, qy = t.q.y, qz = t.q.z, qw = t.q.w;
+            for (size_t i = 0; i < n; ++i) {
+                // rel = rotateInv(q, op - center)
+                float vx = ox[i] - t.center.x, vy = oy[i] - t.center.y, vz = oz[i] - t.center.z;
+                float tx = 2.0f * (qy * vz - qz * vy);
+                float ty = 2.0f * (qz * vx - qx * vz);
+                float tz = 2.0f * (qx * vy - qy * vx);
+                float rx = vx - qw * tx + (qy * tz - qz * ty);
+                float ry = vy - qw * ty + (qz * tx - qx * tz);
+                float rz = vz - qw * tz + (qx * ty - qy * tx);
+
+                float lxz = std::sqrt(rx * rx + rz * rz);
+                float ax  = lxz - t.major;
+                float lq  = std::sqrt(ax * ax + ry * ry);
+                float td  = lq - t.minor;
+
+                // Torus gradient in its local frame, rotated back by q
+                float invLq  = lq  > 0.0f ? 1.0f / lq  : 0.0f;
+                float invLxz = lxz > 0.0f ? 1.0f / lxz : 0.0f;
+                float lgx = ax * rx * invLxz * invLq;
+                float lgy = ry * invLq;
+                float lgz = ax * rz * invLxz * invLq;
+                float ux = 2.0f * (qy * lgz - qz * lgy);
+                float uy = 2.0f * (qz * lgx - qx * lgz);
+                float uz = 2.0f * (qx * lgy - qy * lgx);
+                float tgx = lgx + qw * ux + (qy * uz - qz * uy);
+                float tgy = lgy + qw * uy + (qz * ux - qx * uz);
+                float tgz = lgz + qw * uz + (qx * uy - qy * ux);
+
+                // d = min(d, td) - h²k/4,  h = max(k - |d - td|, 0) / k
+                float diff = d[i] - td;
+                float h    = std::max(BLEND_K - std::fabs(diff), 0.0f) * (1.0f / BLEND_K);
+                float s    = diff < 0.0f ? -0.5f * h : 0.5f * h;   // ½h·sign(d - td)
+                bool  keep = diff < 0.0f;
+                float mgx = keep ? dx[i] : tgx, mgy = keep ? dy[i] : tgy, mgz = keep ? dz[i] : tgz;
+                dx[i] = mgx + s * (dx[i] - tgx);
+                dy[i] = mgy + s * (dy[i] - tgy);
+                dz[i] = mgz + s * (dz[i] - tgz);
+                d[i]  = std::min(d[i], td) - h * h * BLEND_K * 0.25f;
+            }
+        }
+
+        // --- Back to world space: ∇p = Mᵀ·∇op ---
+        for (size_t i = 0; i < n; ++i) {
+            dist[base + i] = d[i];
+            if (!grad) continue;
+            gx[base + i] = c0.x * dx[i] + c0.y * dy[i] + c0.z * dz[i];
+            gy[base + i] = c1.x * dx[i] + c1.y * dy[i] + c1.z * dz[i];
+            gz[base + i] = c2.x * dx[i] + c2.y * dy[i] + c2.z * dz[i];
+        }
+    }
+}
+
+float SceneSDF::distance(const glm::vec3& p, glm::vec3* gradient) const {
+    float d, gx, gy, gz;
+    evaluate(&p.x, &p.y, &p.z, 1, &d, &gx, &gy, &gz);
+    if (gradient) *gradient = glm::vec3(gx, gy, gz);
+    return d;
+}
@@ -0,0 +1,68 @@
+// SceneSDF.hpp
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <string>
+#include <vector>
+#include "SdfExpr.hpp"
+
+class BrickMap;
+
+// CPU mirror of map() in shaders/raymarch.frag: the base shape under the
+// object transform, with one torus per body smooth-min blended in, in
+// submission order. Points are evaluated in batches (tori outer, points
+// inner) and every query yields the distance and its analytic gradient in
+// one pass.
+class SceneSDF {
+public:
+    // Blend radius of the smooth min, as in map()
+    static constexpr float BLEND_K = 0.3f;
+
+    // The static base shape in object space. The shader's baseShape() is
+    // emitted from this same expression (baseGLSL), and BrickMaps are baked
+    // from it.
+    static const auto& baseShape() {
+        static const auto shape = sdf::sphere(1.0f);
+        return shape;
+    }
+    static float baseDistance(const glm::vec3& op) { return baseShape().distance(op); }
+    static float baseBound() { return baseShape().bound(); }   // object-space sphere holding it
+    static std::string baseGLSL() { return sdf::glslFunction(baseShape(), "baseShape"); }
+
+    // Take the base distance from a baked cache instead of baseDistance();
+    // null restores the analytic shape. The cache must outlive its use.
+    void setBaseCache(const BrickMap* cache) { cache_ = cache; }
+
+    // Object transform of the scene (map() uses its inverse); set it before
+    // setTori, which bakes torus centers into object space
+    void setTransform(const glm::mat4& xform);
+
+    // Tori follow the body layout uploaded to the shader: world-space center,
+    // major radius r (minor 0.4·r) and orientation. SoA arrays, `count` each.
+    void setTori(const float* x, const float* y, const float* z, const float* r,
+                 const float* qx, const float* qy, const float* qz, const float* qw, size_t count);
+    void clearTori() { tori_.clear(); }
+    size_t torusCount() const { return tori_.size(); }
+
+    // Distance and world-space gradient at `count` world-space points.
+    // Any gradient pointer may be null when only distances are needed.
+    void evaluate(const float* px, const float* py, const float* pz, size_t count,
+                  float* dist, float* gx, float* gy, float* gz) const;
+
+    // Single-point convenience wrapper
+    float distance(const glm::vec3& p, glm::vec3* gradient = nullptr) const;
+
+private:
+    struct Torus {
+        glm::vec3 center;     // object space
+        float     major, minor;
+        glm::quat q;
+    };
+
+    static constexpr size_t BATCH = 64;
+
+    glm::mat4          inv_{1.0f};
+    const BrickMap*    cache_ = nullptr;
+    std::vector<Torus> tori_;
+};
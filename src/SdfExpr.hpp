@@ -0,0 +1,289 @@
+// SdfExpr.hpp
+#pragma once
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+// Signed distance expressions as a tree of small value types. One tree is
+// both evaluated on the CPU (distance plus analytic gradient, everything
+// inlined through the node templates) and emitted as a GLSL function with
+// its constants folded in, so the shader holds only the operations the
+// shape uses and CPU contacts follow the same formula as the renderer.
+// Build trees with the factory functions at the bottom; they fold nested
+// transforms of one kind into one node.
+namespace sdf {
+
+// Statements of one emitted function, a fresh variable per node
+class GlslWriter {
+public:
+    // Append `type name = expr;` and return the name
+    std::string let(const char* type, const std::string& expr) {
+        std::string name = (type[0] == 'f' ? "d" : "p") + std::to_string(next_++);
+        code_ += "    " + std::string(type) + " " + name + " = " + expr + ";\n";
+        return name;
+    }
+    const std::string& code() const { return code_; }
+
+    // Literal that reads back as exactly v
+    static std::string lit(float v) {
+        char buf[32];
+        std::snprintf(buf, sizeof buf, "%.9g", double(v));
+        std::string s = buf;
+        if (s.find_first_of(".e") == std::string::npos) s += ".0";
+        return s;
+    }
+    static std::string lit(const glm::vec3& v) {
+        return "vec3(" + lit(v.x) + ", " + lit(v.y) + ", " + lit(v.z) + ")";
+    }
+
+private:
+    std::string code_;
+    int         next_ = 0;
+};
+
+// --- Primitives, centred at the origin ---
+
+struct Sphere {
+    float radius;
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const {
+        const float len = glm::length(p);
+        if (grad) *grad = p * (len > 0.0f ? 1.0f / len : 0.0f);
+        return len - radius;
+    }
+    float bound() const { return radius; }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        return w.let("float", "length(" + p + ") - " + GlslWriter::lit(radius));
+    }
+};
+
+struct Box {
+    glm::vec3 half;   // half extents
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const {
+        const glm::vec3 q = glm::abs(p) - half;
+        const glm::vec3 out = glm::max(q, glm::vec3(0.0f));
+        const float outLen = glm::length(out);
+        const float inMax  = std::max(q.x, std::max(q.y, q.z));
+        if (grad) {
+            const glm::vec3 s(p.x < 0.0f ? -1.0f : 1.0f, p.y < 0.0f ? -1.0f : 1.0f, p.z < 0.0f ? -1.0f : 1.0f);
+            if (outLen > 0.0f)         *grad = out / outLen * s;
+            else if (inMax == q.x)     *grad = glm::vec3(s.x, 0.0f, 0.0f);
+            else if (inMax == q.y)     *grad = glm::vec3(0.0f, s.y, 0.0f);
+            else                       *grad = glm::vec3(0.0f, 0.0f, s.z);
+        }
+        return outLen + std::min(inMax, 0.0f);
+    }
+    float bound() const { return glm::length(half); }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        const std::string q = w.let("vec3", "abs(" + p + ") - " + GlslWriter::lit(half));
+        return w.let("float", "length(max(" + q + ", 0.0)) + min(max(" + q + ".x, max(" + q + ".y, " + q + ".z)), 0.0)");
+    }
+};
+
+// Ring in the xz plane
+struct Torus {
+    float major, minor;
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const {
+        const float lxz = std::sqrt(p.x * p.x + p.z * p.z);
+        const float ax  = lxz - major;
+        const float lq  = std::sqrt(ax * ax + p.y * p.y);
+        if (grad) {
+            const float invLq  = lq  > 0.0f ? 1.0f / lq  : 0.0f;
+            const float invLxz = lxz > 0.0f ? 1.0f / lxz : 0.0f;
+            *grad = glm::vec3(ax * p.x * invLxz * invLq, p.y * invLq, ax * p.z * invLxz * invLq);
+        }
+        return lq - minor;
+    }
+    float bound() const { return major + minor; }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        return w.let("float", "length(vec2(length(" + p + ".xz) - " + GlslWriter::lit(major) + ", " + p + ".y)) - " +
+                              GlslWriter::lit(minor));
+    }
+};
+
+// --- Transforms of a child: it is evaluated at the inversely mapped point ---
+
+template <class E>
+struct Translate {
+    glm::vec3 offset;
+    E         child;
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const { return child.distance(p - offset, grad); }
+    float bound() const { return glm::length(offset) + child.bound(); }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        if (offset == glm::vec3(0.0f)) return child.emit(w, p);
+        return child.emit(w, w.let("vec3", p + " - " + GlslWriter::lit(offset)));
+    }
+};
+
+template <class E>
+struct Rotate {
+    glm::mat3 inv;    // world → child: the inverse rotation
+    E         child;
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const {
+        const float d = child.distance(inv * p, grad);
+        if (grad) *grad = glm::transpose(inv) * *grad;
+        return d;
+    }
+    float bound() const { return child.bound(); }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        if (identity()) return child.emit(w, p);
+        std::string m = "mat3(";
+        for (int c = 0; c < 3; ++c)
+            for (int r = 0; r < 3; ++r) m += GlslWriter::lit(inv[c][r]) + (c == 2 && r == 2 ? ")" : ", ");
+        return child.emit(w, w.let("vec3", m + " * " + p));
+    }
+    bool identity() const {
+        return inv[0] == glm::vec3(1, 0, 0) && inv[1] == glm::vec3(0, 1, 0) && inv[2] == glm::vec3(0, 0, 1);
+    }
+};
+
+// Uniform scale; distances scale with it, so the result stays exact
+template <class E>
+struct Scale {
+    float factor;
+    E     child;
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const {
+        return child.distance(p * (1.0f / factor), grad) * factor;
+    }
+    float bound() const { return factor * child.bound(); }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        if (factor == 1.0f) return child.emit(w, p);
+        const std::string d = child.emit(w, w.let("vec3", p + " * " + GlslWriter::lit(1.0f / factor)));
+        return w.let("float", d + " * " + GlslWriter::lit(factor));
+    }
+};
+
+// --- Boolean operations ---
+
+template <class A, class B>
+struct Union {
+    A a;
+    B b;
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const {
+        glm::vec3 ga, gb;
+        const float da = a.distance(p, grad ? &ga : nullptr), db = b.distance(p, grad ? &gb : nullptr);
+        if (grad) *grad = da <= db ? ga : gb;
+        return std::min(da, db);
+    }
+    float bound() const { return std::max(a.bound(), b.bound()); }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        const std::string da = a.emit(w, p), db = b.emit(w, p);
+        return w.let("float", "min(" + da + ", " + db + ")");
+    }
+};
+
+template <class A, class B>
+struct Intersect {
+    A a;
+    B b;
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const {
+        glm::vec3 ga, gb;
+        const float da = a.distance(p, grad ? &ga : nullptr), db = b.distance(p, grad ? &gb : nullptr);
+        if (grad) *grad = da >= db ? ga : gb;
+        return std::max(da, db);
+    }
+    float bound() const { return std::min(a.bound(), b.bound()); }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        const std::string da = a.emit(w, p), db = b.emit(w, p);
+        return w.let("float", "max(" + da + ", " + db + ")");
+    }
+};
+
+// a with b carved out
+template <class A, class B>
+struct Subtract {
+    A a;
+    B b;
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const {
+        glm::vec3 ga, gb;
+        const float da = a.distance(p, grad ? &ga : nullptr), db = b.distance(p, grad ? &gb : nullptr);
+        if (grad) *grad = da >= -db ? ga : -gb;
+        return std::max(da, -db);
+    }
+    float bound() const { return a.bound(); }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        const std::string da = a.emit(w, p), db = b.emit(w, p);
+        return w.let("float", "max(" + da + ", -" + db + ")");
+    }
+};
+
+// Polynomial smooth min of radius k, the blend map() uses for the tori:
+// min(a, b) - h²k/4, h = max(k - |a - b|, 0) / k
+template <class A, class B>
+struct SmoothUnion {
+    float k;
+    A     a;
+    B     b;
+
+    float distance(const glm::vec3& p, glm::vec3* grad = nullptr) const {
+        glm::vec3 ga, gb;
+        const float da = a.distance(p, grad ? &ga : nullptr), db = b.distance(p, grad ? &gb : nullptr);
+        if (k <= 0.0f) {
+            if (grad) *grad = da <= db ? ga : gb;
+            return std::min(da, db);
+        }
+        const float diff = da - db;
+        const float h    = std::max(k - std::fabs(diff), 0.0f) * (1.0f / k);
+        if (grad) {
+            const float s = diff < 0.0f ? -0.5f * h : 0.5f * h;   // ½h·sign(a - b)
+            *grad = (diff < 0.0f ? ga : gb) + s * (ga - gb);
+        }
+        return std::min(da, db) - h * h * (k * 0.25f);
+    }
+    // The blend reaches at most k/4 beyond the nearer surface
+    float bound() const { return std::max(a.bound(), b.bound()) + std::max(k, 0.0f) * 0.25f; }
+    std::string emit(GlslWriter& w, const std::string& p) const {
+        const std::string da = a.emit(w, p), db = b.emit(w, p);
+        if (k <= 0.0f) return w.let("float", "min(" + da + ", " + db + ")");
+        const std::string h = w.let("float", "max(" + GlslWriter::lit(k) + " - abs(" + da + " - " + db + "), 0.0) * " +
+                                             GlslWriter::lit(1.0f / k));
+        return w.let("float", "min(" + da + ", " + db + ") - " + h + " * " + h + " * " + GlslWriter::lit(k * 0.25f));
+    }
+};
+
+// --- Factories ---
+
+inline Sphere sphere(float radius)                   { return { radius }; }
+inline Box    box(const glm::vec3& half)             { return { half }; }
+inline Torus  torus(float major, float minor)        { return { major, minor }; }
+
+template <class E> Translate<E> translate(const glm::vec3& t, const E& e) { return { t, e }; }
+template <class E> Translate<E> translate(const glm::vec3& t, const Translate<E>& e) { return { t + e.offset, e.child }; }
+
+// Rotate the child by q
+template <class E> Rotate<E> rotate(const glm::quat& q, const E& e) {
+    return { glm::transpose(glm::mat3_cast(q)), e };
+}
+template <class E> Rotate<E> rotate(const glm::quat& q, const Rotate<E>& e) {
+    return { e.inv * glm::transpose(glm::mat3_cast(q)), e.child };
+}
+
+template <class E> Scale<E> scale(float s, const E& e)        { return { s, e }; }
+template <class E> Scale<E> scale(float s, const Scale<E>& e) { return { s * e.factor, e.child }; }
+
+template <class A, class B> Union<A, B>       unite(const A& a, const B& b)     { return { a, b }; }
+template <class A, class B> Intersect<A, B>   intersect(const A& a, const B& b) { return { a, b }; }
+template <class A, class B> Subtract<A, B>    subtract(const A& a, const B& b)  { return { a, b }; }
+template <class A, class B> SmoothUnion<A, B> smoothUnion(float k, const A& a, const B& b) { return { k, a, b }; }
+
+// `float name(vec3 p)` computing e
+template <class E>
+std::string glslFunction(const E& e, const char* name) {
+    GlslWriter w;
+    const std::string d = e.emit(w, "p");
+    return "float " + std::string(name) + "(vec3 p) {\n" + w.code() + "    return " + d + ";\n}\n";
+}
+
+} // namespace sdf
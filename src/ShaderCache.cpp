@@ -0,0 +1,145 @@
+// ShaderCache.cpp
+#include "ShaderCache.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// File layout: magic, version, key, binary format, byte count, bytes
+static constexpr uint32_t CACHE_MAGIC   = 0x42505A4Du;   // "MZPB"
+static constexpr uint32_t CACHE_VERSION = 1;
+
+static uint64_t fnv1a(uint64_t h, const std::string& s) {
+    for (unsigned char c : s) { h ^= c; h *= 1099511628211ull; }
+    return h;
+}
+
+static GLuint compileShader(const std::string& src, GLenum type, const std::string& label) {
+    const char* ptr = src.c_str();
+    GLuint s = glCreateShader(type);
+    glShaderSource(s, 1, &ptr, nullptr);
+    glCompileShader(s);
+    GLint ok = GL_FALSE;
+    glGetShaderiv(s, GL_COMPILE_STATUS, &ok);
+    if (!ok) {
+        GLint len; glGetShaderiv(s, GL_INFO_LOG_LENGTH, &len);
+        std::string log(len, ' ');
+        glGetShaderInfoLog(s, len, nullptr, &log[0]);
+        std::cerr << "Compile error in " << label << ":\n" << log;
+        glDeleteShader(s);
+        return 0;
+    }
+    return s;
+}
+
+uint64_t ShaderCache::key(const std::string& vs, const std::string& fs) {
+    if (!probed_) {
+        probed_ = true;
+        GLint formats = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+        binariesSupported_ = formats > 0;
+        for (GLenum e : { GL_VENDOR, GL_RENDERER, GL_VERSION }) {
+            const GLubyte* s = glGetString(e);
+            driver_ += s ? reinterpret_cast<const char*>(s) : "?";
+            driver_ += '\n';
+        }
+    }
+    uint64_t h = 1469598103934665603ull;
+    h = fnv1a(h, driver_);
+    h = fnv1a(h, vs);
+    h = fnv1a(h, std::string(1, '\0'));   // keep "ab"+"c" apart from "a"+"bc"
+    h = fnv1a(h, fs);
+    return h;
+}
+
+GLuint ShaderCache::build(const std::string& vsSource, const std::string& fsSource, const std::string& label) {
+    const uint64_t k = key(vsSource, fsSource);
+    char name[32];
+    std::snprintf(name, sizeof name, "%016llx.bin", (unsigned long long)k);
+    const std::string path = dir_ + "/" + name;
+
+    if (binariesSupported_) {
+        if (GLuint p = load(path, k)) { ++hits_; return p; }
+    }
+    ++misses_;
+
+    // --- Compile & link from source ---
+    GLuint vs = compileShader(vsSource, GL_VERTEX_SHADER,   label + " (vertex)");
+    GLuint fs = compileShader(fsSource, GL_FRAGMENT_SHADER, label + " (fragment)");
+    if (!vs || !fs) {
+        if (vs) glDeleteShader(vs);
+        if (fs) glDeleteShader(fs);
+        return 0;
+    }
+    GLuint program = glCreateProgram();
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    glLinkProgram(program);
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        GLint len; glGetProgramiv(program, GL_INFO_LOG_LENGTH, &len);
+        std::string log(len, ' ');
+        glGetProgramInfoLog(program, len, nullptr, &log[0]);
+        std::cerr << "Link error in " << label << ":\n" << log;
+        glDeleteProgram(program);
+        return 0;
+    }
+    if (binariesSupported_) save(path, k, program);
+    return program;
+}
+
+GLuint ShaderCache::load(const std::string& path, uint64_t k) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return 0;
+    uint32_t magic = 0, version = 0, size = 0;
+    uint64_t fileKey = 0;
+    GLenum   format  = 0;
+    in.read(reinterpret_cast<char*>(&magic),   sizeof magic);
+    in.read(reinterpret_cast<char*>(&version), sizeof version);
+    in.read(reinterpret_cast<char*>(&fileKey), sizeof fileKey);
+    in.read(reinterpret_cast<char*>(&format),  sizeof format);
+    in.read(reinterpret_cast<char*>(&size),    sizeof size);
+    if (!in || magic != CACHE_MAGIC || version != CACHE_VERSION || fileKey != k || size == 0) return 0;
+    std::vector<char> blob(size);
+    if (!in.read(blob.data(), size)) return 0;
+
+    GLuint program = glCreateProgram();
+    glProgramBinary(program, format, blob.data(), GLsizei(size));
+    GLint ok = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &ok);
+    if (!ok) {
+        // Driver rejected it (e.g. updated in place); rebuild from source
+        glDeleteProgram(program);
+        return 0;
+    }
+    return program;
+}
+
+void ShaderCache::save(const std::string& path, uint64_t k, GLuint program) {
+    GLint size = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0) return;
+    std::vector<char> blob(static_cast<size_t>(size));
+    GLenum format = 0;
+    glGetProgramBinary(program, size, nullptr, &format, blob.data());
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Shader cache: cannot write " << path << "\n";
+        return;
+    }
+    uint32_t magic = CACHE_MAGIC, version = CACHE_VERSION, usize = uint32_t(size);
+    out.write(reinterpret_cast<const char*>(&magic),   sizeof magic);
+    out.write(reinterpret_cast<const char*>(&version), sizeof version);
+    out.write(reinterpret_cast<const char*>(&k),       sizeof k);
+    out.write(reinterpret_cast<const char*>(&format),  sizeof format);
+    out.write(reinterpret_cast<const char*>(&usize),   sizeof usize);
+    out.write(blob.data(), size);
+}
@@ -0,0 +1,32 @@
+// ShaderCache.hpp
+#pragma once
+
+#include <glad/glad.h>
+#include <cstdint>
+#include <string>
+
+// Builds vertex+fragment programs, reusing linked binaries from disk
+// (glGetProgramBinary / glProgramBinary). Entries are keyed by a hash of both
+// sources and the driver's vendor/renderer/version strings, so editing a
+// shader or updating the driver simply misses and rebuilds.
+class ShaderCache {
+public:
+    explicit ShaderCache(std::string dir = "shader_cache") : dir_(std::move(dir)) {}
+
+    // Linked program, or 0 on a compile/link error (logged with `label`)
+    GLuint build(const std::string& vsSource, const std::string& fsSource, const std::string& label);
+
+    unsigned hits()   const { return hits_; }
+    unsigned misses() const { return misses_; }
+
+private:
+    uint64_t key(const std::string& vs, const std::string& fs);
+    GLuint   load(const std::string& path, uint64_t key);
+    void     save(const std::string& path, uint64_t key, GLuint program);
+
+    std::string dir_;
+    std::string driver_;
+    bool        binariesSupported_ = false;
+    bool        probed_ = false;
+    unsigned    hits_ = 0, misses_ = 0;
+};
@@ -0,0 +1,108 @@
+// SimThread.cpp
+#include "SimThread.hpp"
+#include "Profiler.hpp"
+#include "SceneFile.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+BodyView SimSnapshot::view() const {
+    BodyView v{ x.data(), y.data(), z.data(), radius.data(),
+                qx.data(), qy.data(), qz.data(), qw.data(), ids.data(), count, {}, {} };
+    v.dirty.add(0, count);
+    v.idsDirty.add(0, count);
+    return v;
+}
+
+void SimThread::start() {
+    if (running_.exchange(true)) return;
+    thread_ = std::thread([this] { run(); });
+}
+
+void SimThread::stop() {
+    if (!running_.exchange(false)) return;
+    thread_.join();
+}
+
+bool SimThread::send(SimEvent e) {
+    e.timeNs = Profiler::nowNs();
+    return events_.push(e);
+}
+
+void SimThread::run() {
+    using clock = std::chrono::steady_clock;
+    auto last = clock::now();
+    publish(0.0f, 0.0f);
+
+    while (running_.load(std::memory_order_relaxed)) {
+        // --- Everything the render thread sent since the last pass ---
+        SimEvent e;
+        uint64_t oldest = 0;
+        while (events_.pop(e)) {
+            if (!oldest) oldest = e.timeNs;
+            apply(e);
+        }
+        const float latencyMs = oldest ? float(Profiler::nowNs() - oldest) * 1e-6f : 0.0f;
+
+        // --- Advance by the wall time since the last pass ---
+        const auto t0 = clock::now();
+        const float frameDt = std::chrono::duration<float>(t0 - last).count();
+        last = t0;
+        int ticks;
+        {
+            PROFILE_ZONE("sim advance");
+            ticks = sim_.advance(frameDt);
+        }
+        const float simMs = std::chrono::duration<float, std::milli>(clock::now() - t0).count();
+        if (ticks > 0 || !sim_.world().dirty().empty()) publish(simMs, latencyMs);
+
+        // --- Sleep until the next tick is due ---
+        const float wait = (1.0f - sim_.alpha()) * sim_.tickDt();
+        std::this_thread::sleep_for(std::chrono::duration<float>(wait));
+    }
+}
+
+void SimThread::apply(const SimEvent& e) {
+    PhysicsWorld& world = sim_.world();
+    switch (e.type) {
+    case SimEvent::Type::Input:         lastInput_ = e.input; break;
+    case SimEvent::Type::Spawn:         world.spawn(&e.body, 1); break;
+    case SimEvent::Type::SpawnCloud:    sim_.spawnRandom(e.count, e.seed, e.extent, e.body.radius, e.density); break;
+    case SimEvent::Type::DespawnFirst:  if (world.size()) world.despawn(world.ids()[0]); break;
+    case SimEvent::Type::ToggleExact: {
+        bool& exact = sim_.config().physics.gravity.exact;
+        exact = !exact;
+        break;
+    }
+    case SimEvent::Type::SaveScene:
+        if (saveScene(scenePath_, world, sim_.config().physics.sdfXform))
+            std::cout << "Saved " << world.size() << " bodies to " << scenePath_ << "\n";
+        break;
+    }
+}
+
+void SimThread::publish(float simMs, float latencyMs) {
+    PROFILE_ZONE("sim publish");
+    PhysicsWorld& world = sim_.world();
+    if (!world.idsDirty().empty()) ++idsVersion_;
+
+    // --- Copy into the slot the renderer is not reading ---
+    SimSnapshot& s = snapshots_.writeBuffer();
+    const size_t n = world.size();
+    auto copy = [n](std::vector<float>& dst, const float* src) { dst.assign(src, src + n); };
+    copy(s.x, world.x());   copy(s.y, world.y());   copy(s.z, world.z());   copy(s.radius, world.radii());
+    copy(s.qx, world.qx()); copy(s.qy, world.qy()); copy(s.qz, world.qz()); copy(s.qw, world.qw());
+    s.ids.assign(world.ids(), world.ids() + n);
+    s.count      = n;
+    s.tick       = sim_.tickCount();
+    s.idsVersion = idsVersion_;
+    s.broadphase = world.broadphase().stats();
+    s.kernels    = world.kernels().name;
+    s.exact      = sim_.config().physics.gravity.usesExact(n);
+    s.simMs      = simMs;
+    s.latencyMs  = latencyMs;
+    snapshots_.publish();
+
+    if (recorder_ && recorder_->isOpen()) recorder_->append(world, sim_.tickCount(), lastInput_);
+    world.clearDirty();
+}
@@ -0,0 +1,94 @@
+// SimThread.hpp
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Recording.hpp"
+#include "Simulation.hpp"
+#include "SpscQueue.hpp"
+#include "TripleBuffer.hpp"
+
+// Render thread → sim thread message, stamped with Profiler::nowNs()
+struct SimEvent {
+    enum class Type : uint32_t {
+        Input,          // `input`: this frame's camera and raw input (recorded with the ticks)
+        Spawn,          // `body`
+        SpawnCloud,     // spawnRandom(count, seed, extent, body.radius, density)
+        DespawnFirst,   // the body at index 0; any body once others were despawned
+        ToggleExact,    // all-pairs gravity on/off
+        SaveScene,      // write the bodies to the scene path (see setScenePath)
+    };
+    Type       type   = Type::Input;
+    uint64_t   timeNs = 0;
+    FrameInput input;
+    BodyDesc   body{ glm::vec3(0.0f), 0.0f, 0.0f, 0.0f };
+    uint32_t   count   = 0;
+    uint64_t   seed    = 0;
+    float      extent  = 0.0f;
+    float      density = 1.0f;
+};
+
+// Immutable copy of what the renderer needs from one simulation state
+struct SimSnapshot {
+    std::vector<float>    x, y, z, radius, qx, qy, qz, qw;
+    std::vector<unsigned> ids;
+    size_t          count      = 0;
+    uint64_t        tick       = 0;
+    uint64_t        idsVersion = 0;     // bumps whenever bodies are added or removed
+    BroadphaseStats broadphase;
+    const char*     kernels    = "";
+    bool            exact      = false;   // gravity took the all-pairs path
+    float           simMs      = 0.0f;  // CPU time of the last advance
+    float           latencyMs  = 0.0f;  // oldest event → applied, for the last batch
+
+    // Every body dirty; narrow it with what the consumer has already seen
+    BodyView view() const;
+};
+
+// Runs a Simulation on its own thread at its tick rate. The render thread
+// sends SimEvents through an SPSC queue and reads the newest SimSnapshot
+// through a triple buffer, so physics of frame N+1 overlaps rendering and
+// GPU submission of frame N; neither side takes a lock.
+class SimThread {
+public:
+    explicit SimThread(Simulation& sim) : sim_(sim) {}
+    ~SimThread() { stop(); }
+
+    SimThread(const SimThread&) = delete;
+    SimThread& operator=(const SimThread&) = delete;
+
+    // The simulation belongs to the sim thread between start() and stop()
+    void start();
+    void stop();
+
+    // Append one chunk per published state (set before start)
+    void setRecorder(RecordingWriter* recorder) { recorder_ = recorder; }
+
+    // Where SaveScene writes (set before start)
+    void setScenePath(std::string path) { scenePath_ = std::move(path); }
+
+    // Render thread: queue an event; false if the queue is full
+    bool send(SimEvent e);
+
+    // Render thread: take the newest snapshot; true if it changed
+    bool acquire() { return snapshots_.update(); }
+    const SimSnapshot& snapshot() const { return snapshots_.read(); }
+
+private:
+    void run();
+    void apply(const SimEvent& e);
+    void publish(float simMs, float latencyMs);
+
+    Simulation&               sim_;
+    RecordingWriter*          recorder_ = nullptr;
+    std::string               scenePath_;
+    std::thread               thread_;
+    std::atomic<bool>         running_{false};
+    SpscQueue<SimEvent, 256>  events_;
+    TripleBuffer<SimSnapshot> snapshots_;
+    FrameInput                lastInput_;
+    uint64_t                  idsVersion_ = 0;
+};
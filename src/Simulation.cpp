@@ -0,0 +1,71 @@
+// Simulation.cpp
+#include "Simulation.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+int Simulation::advance(float frameDt) {
+    const float dt = tickDt();
+    accumulator_ += std::max(frameDt, 0.0f);
+
+    int n = 0;
+    while (accumulator_ >= dt && n < cfg_.maxTicksPerCall) {
+        tick();
+        accumulator_ -= dt;
+        ++n;
+    }
+    // Spiral-of-death guard: forget the backlog instead of chasing it
+    if (accumulator_ >= dt) accumulator_ = std::fmod(accumulator_, dt);
+    return n;
+}
+
+void Simulation::tick() {
+    world_.step(cfg_.physics, tickDt());
+    ++ticks_;
+}
+
+// splitmix64: fixed integer sequence, unlike the <random> distributions
+static uint64_t splitmix(uint64_t& s) {
+    uint64_t z = (s += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in [-1, 1) from the top 24 bits
+static float signedUnit(uint64_t& s) {
+    return float(splitmix(s) >> 40) * (2.0f / 16777216.0f) - 1.0f;
+}
+
+void Simulation::spawnRandom(size_t count, uint64_t seed, float halfExtent, float radius, float density) {
+    const float mass    = density * (4.0f / 3.0f) * 3.14159265f * radius * radius * radius;
+    const float inertia = 0.4f * mass * radius * radius;
+    uint64_t s = seed;
+    std::vector<BodyDesc> bodies(count);
+    for (BodyDesc& b : bodies) {
+        float x = signedUnit(s), y = signedUnit(s), z = signedUnit(s);
+        b = { glm::vec3(x, y, z) * halfExtent, radius, mass, inertia };
+    }
+    world_.spawn(bodies.data(), bodies.size());
+}
+
+uint64_t Simulation::checksum() const {
+    uint64_t h = 1469598103934665603ull;
+    auto mix = [&h](float v) {
+        uint32_t bits;
+        std::memcpy(&bits, &v, sizeof bits);
+        for (int k = 0; k < 4; ++k) {
+            h ^= (bits >> (8 * k)) & 0xFFu;
+            h *= 1099511628211ull;
+        }
+    };
+    for (size_t i = 0; i < world_.size(); ++i) {
+        glm::vec3 p = world_.position(i), v = world_.velocity(i);
+        glm::quat q = world_.orientation(i);
+        mix(p.x); mix(p.y); mix(p.z);
+        mix(v.x); mix(v.y); mix(v.z);
+        mix(q.x); mix(q.y); mix(q.z); mix(q.w);
+    }
+    return h;
+}
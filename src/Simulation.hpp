@@ -0,0 +1,49 @@
+// Simulation.hpp
+#pragma once
+
+#include <cstdint>
+#include "PhysicsWorld.hpp"
+
+struct SimulationConfig {
+    PhysicsConfig physics;
+    float tickRate        = 120.0f;  // fixed steps per second
+    int   maxTicksPerCall = 8;       // cap on catch-up after a long frame
+};
+
+// Owns the body world and advances it in fixed ticks. Wall-clock frame times
+// only feed the accumulator, so a run is a pure function of the spawned bodies,
+// the config and the number of ticks — no SDL or GL involved.
+class Simulation {
+public:
+    explicit Simulation(const SimulationConfig& cfg = {}) : cfg_(cfg) {}
+
+    // Bank frameDt and run as many whole ticks as it covers; returns the count.
+    // Time beyond maxTicksPerCall is dropped rather than carried over.
+    int advance(float frameDt);
+
+    // Run exactly one fixed tick
+    void tick();
+
+    // Spawn `count` bodies of radius `radius` in a cube of half-extent
+    // `halfExtent`, from a seeded generator that is identical on every platform
+    void spawnRandom(size_t count, uint64_t seed, float halfExtent, float radius, float density);
+
+    // FNV-1a over the positions, velocities and orientations of all bodies
+    uint64_t checksum() const;
+
+    // Fraction of a tick left in the accumulator, for render interpolation
+    float alpha() const { return accumulator_ * cfg_.tickRate; }
+    float tickDt() const { return 1.0f / cfg_.tickRate; }
+    uint64_t tickCount() const { return ticks_; }
+
+    SimulationConfig&       config()       { return cfg_; }
+    const SimulationConfig& config() const { return cfg_; }
+    PhysicsWorld&           world()        { return world_; }
+    const PhysicsWorld&     world()  const { return world_; }
+
+private:
+    SimulationConfig cfg_;
+    PhysicsWorld     world_;
+    float            accumulator_ = 0.0f;
+    uint64_t         ticks_       = 0;
+};
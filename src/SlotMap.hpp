@@ -0,0 +1,103 @@
+// SlotMap.hpp
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Half-open range of dense indices whose data changed; empty when begin == end
+struct DirtyRange {
+    size_t begin = 0, end = 0;
+
+    bool empty() const { return begin >= end; }
+    void add(size_t b, size_t e) {
+        if (b >= e) return;
+        if (empty()) { begin = b; end = e; }
+        else         { begin = std::min(begin, b); end = std::max(end, e); }
+    }
+    void clear() { begin = end = 0; }
+};
+
+// Generational handle → dense index table for data kept packed elsewhere
+// (swap-remove on erase). A handle is the slot in the low INDEX_BITS and a
+// generation in the rest; the generation never wraps to 0, so 0 is never a
+// valid handle and stale handles stop resolving once their slot is reused.
+class SlotMap {
+public:
+    using Handle = uint32_t;
+    static constexpr unsigned INDEX_BITS = 22;
+    static constexpr uint32_t MAX_SLOTS  = 1u << INDEX_BITS;
+    static constexpr uint32_t GEN_MAX    = (1u << (32 - INDEX_BITS)) - 1;
+    static constexpr size_t   npos       = size_t(-1);
+
+    // New handle resolving to `dense`; 0 if every slot is in use
+    Handle insert(uint32_t dense) {
+        uint32_t slot;
+        if (!free_.empty()) {
+            slot = free_.back();
+            free_.pop_back();
+        } else {
+            if (dense_.size() == MAX_SLOTS) return 0;
+            slot = uint32_t(dense_.size());
+            dense_.push_back(0);
+            gen_.push_back(1);
+        }
+        dense_[slot] = dense;
+        return (gen_[slot] << INDEX_BITS) | slot;
+    }
+
+    // Point a live handle at a new dense index (after a swap-remove)
+    void move(Handle h, uint32_t dense) { dense_[h & (MAX_SLOTS - 1)] = dense; }
+
+    // Invalidate h and recycle its slot; false if h was already stale
+    bool erase(Handle h) {
+        if (!contains(h)) return false;
+        uint32_t slot = h & (MAX_SLOTS - 1);
+        gen_[slot] = gen_[slot] == GEN_MAX ? 1 : gen_[slot] + 1;
+        free_.push_back(slot);
+        return true;
+    }
+
+    bool contains(Handle h) const {
+        uint32_t slot = h & (MAX_SLOTS - 1);
+        return h != 0 && slot < gen_.size() && gen_[slot] == (h >> INDEX_BITS);
+    }
+
+    // Dense index of h, or npos if it is stale
+    size_t index(Handle h) const {
+        return contains(h) ? dense_[h & (MAX_SLOTS - 1)] : npos;
+    }
+
+    // Rebuild so that handles[i] resolves to i, e.g. to restore saved ids;
+    // every other slot is free. False (map empty) on a zero or repeated slot.
+    bool assign(const Handle* handles, size_t count) {
+        dense_.clear();
+        gen_.clear();
+        free_.clear();
+        uint32_t slots = 0;
+        for (size_t i = 0; i < count; ++i) slots = std::max(slots, (handles[i] & (MAX_SLOTS - 1)) + 1);
+        dense_.assign(slots, uint32_t(npos));
+        gen_.assign(slots, 1);
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t slot = handles[i] & (MAX_SLOTS - 1), gen = handles[i] >> INDEX_BITS;
+            if (gen == 0 || dense_[slot] != uint32_t(npos)) {
+                dense_.clear(); gen_.clear();
+                return false;
+            }
+            dense_[slot] = uint32_t(i);
+            gen_[slot]   = gen;
+        }
+        // Lowest free slot is reused first
+        for (uint32_t slot = slots; slot-- > 0;)
+            if (dense_[slot] == uint32_t(npos)) free_.push_back(slot);
+        return true;
+    }
+
+    void reserve(size_t n) { dense_.reserve(n); gen_.reserve(n); }
+
+private:
+    std::vector<uint32_t> dense_;  // slot → dense index
+    std::vector<uint32_t> gen_;    // slot → current generation
+    std::vector<uint32_t> free_;   // recycled slots
+};
@@ -0,0 +1,94 @@
+// StreamBuffer.cpp
+#include "StreamBuffer.hpp"
+#include <algorithm>
+#include <iostream>
+
+// Smallest region, and the granularity regions are rounded up to
+static constexpr size_t MIN_REGION = 4096;
+
+StreamBuffer::~StreamBuffer() {
+    release();
+}
+
+uint8_t* StreamBuffer::map(size_t bytes) {
+    if (bytes > capacity_ || !buffer_) allocate(std::max(bytes, capacity_ * 2));
+    if (!mapped_) return nullptr;
+
+    // --- Wait for the GPU to finish with this region ---
+    if (GLsync f = fences_[head_]) {
+        for (;;) {
+            GLenum r = glClientWaitSync(f, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);  // 1 ms
+            if (r == GL_ALREADY_SIGNALED || r == GL_CONDITION_SATISFIED) break;
+            if (r == GL_WAIT_FAILED) { std::cerr << "StreamBuffer: fence wait failed\n"; break; }
+        }
+        glDeleteSync(f);
+        fences_[head_] = nullptr;
+    }
+    current_ = head_;
+    pendingBegin_ = staleBegin_[current_];
+    pendingEnd_   = staleEnd_[current_];
+    staleBegin_[current_] = staleEnd_[current_] = 0;
+    return mapped_ + current_ * capacity_;
+}
+
+void StreamBuffer::invalidate(size_t begin, size_t end) {
+    if (begin >= end) return;
+    for (int r = 0; r < REGIONS; ++r) {
+        if (staleBegin_[r] >= staleEnd_[r]) { staleBegin_[r] = begin; staleEnd_[r] = end; }
+        else { staleBegin_[r] = std::min(staleBegin_[r], begin); staleEnd_[r] = std::max(staleEnd_[r], end); }
+    }
+}
+
+void StreamBuffer::bind(GLenum target, GLuint index, size_t bytes) const {
+    if (!mapped_) return;
+    glBindBufferRange(target, index, buffer_,
+                      GLintptr(current_ * capacity_),
+                      GLsizeiptr(bytes ? bytes : capacity_));
+}
+
+void StreamBuffer::fence() {
+    if (!mapped_) return;
+    // A region drawn twice without a new map() keeps only the newest fence
+    if (fences_[current_]) glDeleteSync(fences_[current_]);
+    fences_[current_] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    if (current_ == head_) head_ = (head_ + 1) % REGIONS;
+}
+
+void StreamBuffer::allocate(size_t bytes) {
+    release();
+
+    // Region offsets must respect the strictest binding alignment in use
+    GLint align = 256;
+    glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &align);
+    size_t granule = std::max<size_t>(MIN_REGION, size_t(align));
+    capacity_ = (std::max(bytes, size_t(1)) + granule - 1) / granule * granule;
+
+    const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+    glGenBuffers(1, &buffer_);
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer_);
+    glBufferStorage(GL_SHADER_STORAGE_BUFFER, GLsizeiptr(capacity_ * REGIONS), nullptr, flags);
+    mapped_ = static_cast<uint8_t*>(
+        glMapBufferRange(GL_SHADER_STORAGE_BUFFER, 0, GLsizeiptr(capacity_ * REGIONS), flags));
+    glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+    if (!mapped_) std::cerr << "StreamBuffer: persistent map of " << capacity_ * REGIONS << " bytes failed\n";
+    head_ = current_ = 0;
+    // Fresh storage holds nothing yet
+    for (int r = 0; r < REGIONS; ++r) { staleBegin_[r] = 0; staleEnd_[r] = capacity_; }
+}
+
+void StreamBuffer::release() {
+    for (GLsync& f : fences_) {
+        if (f) glDeleteSync(f);
+        f = nullptr;
+    }
+    if (buffer_) {
+        // GL keeps the storage alive until in-flight draws that read it retire
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer_);
+        glUnmapBuffer(GL_SHADER_STORAGE_BUFFER);
+        glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+        glDeleteBuffers(1, &buffer_);
+    }
+    buffer_   = 0;
+    mapped_   = nullptr;
+    capacity_ = 0;
+}
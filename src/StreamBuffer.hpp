@@ -0,0 +1,59 @@
+// StreamBuffer.hpp
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+
+// Persistently mapped, coherent GL buffer split into a ring of REGIONS equal
+// regions. The CPU writes one region per frame while the GPU may still read
+// the previous ones; a fence per region keeps the writer from overtaking.
+// Capacity grows geometrically; growing drops the old contents.
+//
+// Writers that only change part of the data can track it per region: after
+// invalidate(), each region reports the stale bytes through pending() the
+// next time it is mapped, so unchanged bytes are never rewritten.
+class StreamBuffer {
+public:
+    static constexpr int REGIONS = 3;
+
+    StreamBuffer() = default;
+    ~StreamBuffer();
+
+    StreamBuffer(const StreamBuffer&) = delete;
+    StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+    // Wait until the next region is free and return it, with room for at
+    // least `bytes` bytes; nullptr if the buffer could not be mapped
+    uint8_t* map(size_t bytes);
+
+    // Mark bytes [begin, end) changed; every region rewrites them when next mapped
+    void invalidate(size_t begin, size_t end);
+
+    // Stale bytes of the region last mapped, as [begin, end) (empty when
+    // begin >= end); everything after a growth
+    size_t pendingBegin() const { return pendingBegin_; }
+    size_t pendingEnd()   const { return pendingEnd_; }
+
+    // Bind the last mapped region to an indexed target (e.g. an SSBO slot);
+    // bytes = 0 binds the whole region
+    void bind(GLenum target, GLuint index, size_t bytes) const;
+
+    // Call after the draw that reads the bound region
+    void fence();
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    void allocate(size_t bytes);
+    void release();
+
+    GLuint   buffer_   = 0;
+    uint8_t* mapped_   = nullptr;
+    size_t   capacity_ = 0;       // bytes per region
+    int      head_     = 0;       // next region to map
+    int      current_  = 0;       // region last mapped
+    GLsync   fences_[REGIONS] = {};
+    size_t   staleBegin_[REGIONS] = {}, staleEnd_[REGIONS] = {};
+    size_t   pendingBegin_ = 0, pendingEnd_ = 0;
+};
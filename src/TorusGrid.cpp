@@ -0,0 +1,71 @@
+// TorusGrid.cpp
+#include "TorusGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Bounding radius of a torus relative to its major radius (1 + 0.4)
+static constexpr float TORUS_BOUND = 1.4f;
+
+void TorusGrid::build(const float* x, const float* y, const float* z, const float* radii,
+                      size_t count, float inflate, FrameArena& frame)
+{
+    const uint32_t n = uint32_t(count);
+    items_.clear();
+    if (n == 0) {
+        dims_ = glm::ivec3(0);
+        cellStart_.assign(1, 0);
+        return;
+    }
+
+    // --- Bounds of every inflated torus sphere ---
+    glm::vec3 lo( 1e30f), hi(-1e30f);
+    float maxR = 0.0f;
+    for (uint32_t i = 0; i < n; ++i) {
+        float R = radii[i] * TORUS_BOUND + inflate;
+        glm::vec3 p(x[i], y[i], z[i]);
+        lo = glm::min(lo, p - R);
+        hi = glm::max(hi, p + R);
+        maxR = std::max(maxR, R);
+    }
+
+    // --- Cell size: 2 * largest bound, coarsened to stay under MAX_CELLS ---
+    const glm::vec3 extent = hi - lo;
+    float cell = std::max(2.0f * maxR, 1e-4f);
+    for (;;) {
+        glm::vec3 d = glm::max(glm::vec3(1.0f), glm::vec3(
+            std::ceil(extent.x / cell), std::ceil(extent.y / cell), std::ceil(extent.z / cell)));
+        if (double(d.x) * d.y * d.z <= MAX_CELLS) { dims_ = glm::ivec3(d); break; }
+        cell *= 1.25f;
+    }
+    origin_   = lo;
+    cellSize_ = cell;
+    const uint32_t cells = uint32_t(dims_.x) * dims_.y * dims_.z;
+
+    // --- Counting sort of (cell, torus) entries ---
+    glm::ivec3* cellLo = frame.allocate<glm::ivec3>(n);   // cell range per torus
+    glm::ivec3* cellHi = frame.allocate<glm::ivec3>(n);
+    cellStart_.assign(cells + 1, 0);
+    const float inv = 1.0f / cell;
+    const glm::ivec3 last = dims_ - glm::ivec3(1);
+    for (uint32_t i = 0; i < n; ++i) {
+        float R = radii[i] * TORUS_BOUND + inflate;
+        glm::vec3 p(x[i], y[i], z[i]);
+        cellLo[i] = glm::clamp(glm::ivec3(glm::floor((p - R - origin_) * inv)), glm::ivec3(0), last);
+        cellHi[i] = glm::clamp(glm::ivec3(glm::floor((p + R - origin_) * inv)), glm::ivec3(0), last);
+        for (int cz = cellLo[i].z; cz <= cellHi[i].z; ++cz)
+        for (int cy = cellLo[i].y; cy <= cellHi[i].y; ++cy)
+        for (int cx = cellLo[i].x; cx <= cellHi[i].x; ++cx)
+            ++cellStart_[uint32_t(cx + dims_.x * (cy + dims_.y * cz)) + 1];
+    }
+    for (uint32_t c = 0; c < cells; ++c) cellStart_[c + 1] += cellStart_[c];
+    items_.resize(cellStart_[cells]);
+    // Fill in ascending body order so map() blends in the same order as before
+    for (uint32_t i = 0; i < n; ++i) {
+        for (int cz = cellLo[i].z; cz <= cellHi[i].z; ++cz)
+        for (int cy = cellLo[i].y; cy <= cellHi[i].y; ++cy)
+        for (int cx = cellLo[i].x; cx <= cellHi[i].x; ++cx)
+            items_[cellStart_[uint32_t(cx + dims_.x * (cy + dims_.y * cz))]++] = i;
+    }
+    for (uint32_t c = cells; c > 0; --c) cellStart_[c] = cellStart_[c - 1];
+    cellStart_[0] = 0;
+}
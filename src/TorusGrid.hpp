@@ -0,0 +1,39 @@
+// TorusGrid.hpp
+#pragma once
+
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+#include "FrameArena.hpp"
+
+// World-space uniform grid over the bounds of the rendered tori, rebuilt
+// every frame and uploaded for map() in raymarch.frag. A torus of radius r
+// has bounding radius 1.4·r (major + minor); it is listed in every cell its
+// bound, inflated by the smooth-min radius, touches. Cells are about twice
+// the largest inflated bound, so each torus lands in at most eight.
+class TorusGrid {
+public:
+    // Hard cap on grid cells; the cell size grows to respect it
+    static constexpr uint32_t MAX_CELLS = 1u << 18;
+
+    // Per-torus cell ranges are scratch drawn from `frame`
+    void build(const float* x, const float* y, const float* z, const float* radii,
+               size_t count, float inflate, FrameArena& frame);
+
+    const glm::vec3&  origin()   const { return origin_; }
+    float             cellSize() const { return cellSize_; }
+    const glm::ivec3& dims()     const { return dims_; }
+    uint32_t          cellCount() const { return uint32_t(cellStart_.size()) - 1; }
+
+    // Prefix sums, cellCount() + 1 entries; items of cell c are
+    // items()[cellStart()[c] .. cellStart()[c + 1]), in ascending body order
+    const std::vector<uint32_t>& cellStart() const { return cellStart_; }
+    const std::vector<uint32_t>& items()     const { return items_; }
+
+private:
+    glm::vec3  origin_{0.0f};
+    float      cellSize_ = 1.0f;
+    glm::ivec3 dims_{0};
+    std::vector<uint32_t> cellStart_{0u};
+    std::vector<uint32_t> items_;
+};
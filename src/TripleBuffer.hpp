@@ -0,0 +1,42 @@
+// TripleBuffer.hpp
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer / single-consumer triple buffer. The writer fills
+// writeBuffer() and publishes it; the reader picks up the newest published
+// slot with update() and keeps reading it until the next update(). Neither
+// side ever waits, and a slot is never written while it is being read; the
+// reader skips states it was too slow to see.
+template <class T>
+class TripleBuffer {
+public:
+    // Writer: the slot to fill, untouched by the reader
+    T& writeBuffer() { return slots_[write_]; }
+
+    // Writer: hand the filled slot over, marked fresh, and take back the old middle one
+    void publish() {
+        uint32_t prev = middle_.exchange(write_ | FRESH, std::memory_order_acq_rel);
+        write_ = prev & INDEX;
+    }
+
+    // Reader: swap in the newest published slot; false if nothing new
+    bool update() {
+        if (!(middle_.load(std::memory_order_acquire) & FRESH)) return false;
+        uint32_t prev = middle_.exchange(read_, std::memory_order_acq_rel);
+        read_ = prev & INDEX;
+        return true;
+    }
+
+    // Reader: the slot taken by the last update()
+    const T& read() const { return slots_[read_]; }
+
+private:
+    static constexpr uint32_t INDEX = 3, FRESH = 4;
+
+    T        slots_[3];
+    uint32_t write_ = 0;                    // writer-owned
+    alignas(64) std::atomic<uint32_t> middle_{1};
+    alignas(64) uint32_t read_ = 2;         // reader-owned
+};
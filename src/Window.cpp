@@ -40,7 +40,7 @@ bool Window::init(int width, int height, const char* title) {
         std::cerr << "Failed to initialize GLAD\n";
         return false;
     }
-    SDL_GL_SetSwapInterval(1);
+    setVSync(vsync_);
 
     // Set initial viewport
     glViewport(0, 0, width, height);
@@ -133,3 +133,16 @@ void Window::toggleFullscreen() {
         SDL_SetWindowFullscreen(window_, SDL_WINDOW_FULLSCREEN_DESKTOP);
     }
 }
+
+VSync Window::setVSync(VSync mode) {
+    const int interval = mode == VSync::Off ? 0 : mode == VSync::On ? 1 : -1;
+    if (SDL_GL_SetSwapInterval(interval) == 0) {
+        vsync_ = mode;
+    } else if (mode == VSync::Adaptive && SDL_GL_SetSwapInterval(1) == 0) {
+        std::cerr << "Adaptive vsync unsupported, using vsync: " << SDL_GetError() << "\n";
+        vsync_ = VSync::On;
+    } else {
+        std::cerr << "SDL_GL_SetSwapInterval Error: " << SDL_GetError() << "\n";
+    }
+    return vsync_;
+}
@@ -2,6 +2,8 @@
 #include <SDL.h>
 #include <string>
 
+enum class VSync { Off, On, Adaptive };
+
 class Window {
 public:
     Window();
@@ -18,6 +20,10 @@ public:
     void setTitle(const std::string& title);
     // Toggle fullscreen on/off
     void toggleFullscreen();
+    // Swap interval; Adaptive (late swaps tear instead of waiting a whole
+    // refresh) falls back to On where unsupported. Returns the mode in effect.
+    VSync setVSync(VSync mode);
+    VSync vsync() const { return vsync_; }
 
     bool isOpen() const { return open_; }
 
@@ -25,6 +31,7 @@ private:
     SDL_Window*   window_    = nullptr;
     SDL_GLContext glContext_ = nullptr;
     bool          open_      = false;
+    VSync         vsync_     = VSync::On;
     bool          dragging_  = false;
     int           dragOffsetX_ = 0, dragOffsetY_ = 0;
 
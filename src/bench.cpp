@@ -0,0 +1,341 @@
+// bench.cpp — microbenchmarks of the physics and SDF hot loops, no SDL or GL
+//
+//   MetharizonBench [--bodies 100,1000,...] [--threads 1,2,...] [--kernels a,b,...]
+//                   [--simd scalar|sse2|avx2] [--min-time S]
+//                   [--baseline old.txt [--tolerance F]]
+//
+// Sweeps every kernel over body counts and thread counts and prints one
+// key=value line per case:
+//
+//   bench=gravity bodies=1000 threads=4 simd=avx2 iters=120 ns_per_iter=...
+//         ns_per_body=... pairs_per_sec=... allocs_per_iter=...
+//
+// Kernels: gravity (Barnes-Hut, all-pairs below GravityConfig::exactBelow),
+// exact (all-pairs gravity, up to 20k bodies), broadphase (grid pair search),
+// integrate (linear + spin kernels), sdf (SceneSDF queries against 64 tori),
+// brickmap (cached base-shape lookups, see BrickMap) and step (a whole
+// PhysicsWorld step).
+// pairs_per_sec counts body pairs (exact, broadphase, step) or point–torus
+// evaluations (sdf); 0 where there is no meaningful pair count. Allocations
+// are counted through the global operator new while the kernel runs.
+//
+// With --baseline, ns_per_body is compared against a previous run's output;
+// cases slower by more than the tolerance (default 0.10) are reported as
+// regression= lines and the exit code is 2.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "BrickMap.hpp"
+#include "Broadphase.hpp"
+#include "Gravity.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include "SceneSDF.hpp"
+#include "Simulation.hpp"
+
+// --- Allocation counting: every global new goes through here ---
+
+static std::atomic<uint64_t> g_allocs{0};
+
+static void* countedAlloc(size_t size, size_t align) {
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (align <= alignof(std::max_align_t)) {
+        if (void* p = std::malloc(size ? size : 1)) return p;
+        throw std::bad_alloc();
+    }
+    // Over-allocate and keep the malloc pointer just below the aligned block
+    void* raw = std::malloc(size + align + sizeof(void*));
+    if (!raw) throw std::bad_alloc();
+    uintptr_t p = (reinterpret_cast<uintptr_t>(raw) + sizeof(void*) + align - 1) & ~uintptr_t(align - 1);
+    reinterpret_cast<void**>(p)[-1] = raw;
+    return reinterpret_cast<void*>(p);
+}
+
+static void countedFree(void* p, size_t align) {
+    if (!p) return;
+    if (align <= alignof(std::max_align_t)) std::free(p);
+    else                                    std::free(static_cast<void**>(p)[-1]);
+}
+
+void* operator new  (size_t n)                         { return countedAlloc(n, 0); }
+void* operator new[](size_t n)                         { return countedAlloc(n, 0); }
+void* operator new  (size_t n, std::align_val_t a)     { return countedAlloc(n, size_t(a)); }
+void* operator new[](size_t n, std::align_val_t a)     { return countedAlloc(n, size_t(a)); }
+void  operator delete  (void* p) noexcept                          { countedFree(p, 0); }
+void  operator delete[](void* p) noexcept                          { countedFree(p, 0); }
+void  operator delete  (void* p, size_t) noexcept                  { countedFree(p, 0); }
+void  operator delete[](void* p, size_t) noexcept                  { countedFree(p, 0); }
+void  operator delete  (void* p, std::align_val_t a) noexcept          { countedFree(p, size_t(a)); }
+void  operator delete[](void* p, std::align_val_t a) noexcept          { countedFree(p, size_t(a)); }
+void  operator delete  (void* p, size_t, std::align_val_t a) noexcept  { countedFree(p, size_t(a)); }
+void  operator delete[](void* p, size_t, std::align_val_t a) noexcept  { countedFree(p, size_t(a)); }
+
+// --- Options ---
+
+struct Options {
+    std::vector<size_t>      bodies  = { 100, 300, 1000, 3000, 10000, 30000, 100000 };
+    std::vector<unsigned>    threads;                  // empty = 1, 2, 4, ... hardware
+    std::vector<std::string> kernels = { "gravity", "exact", "broadphase", "integrate", "sdf", "brickmap", "step" };
+    int         simd      = -1;
+    double      minTime   = 0.25;                      // seconds per case
+    std::string baseline;
+    double      tolerance = 0.10;
+};
+
+static constexpr size_t EXACT_MAX_BODIES = 20000;
+static constexpr size_t SDF_TORI         = 64;
+
+static void usage() {
+    std::cerr << "usage: MetharizonBench [--bodies 100,1000,...] [--threads 1,2,...] [--kernels a,b,...]\n"
+                 "                       [--simd scalar|sse2|avx2] [--min-time S]\n"
+                 "                       [--baseline old.txt [--tolerance F]]\n"
+                 "kernels: gravity exact broadphase integrate sdf brickmap step\n";
+}
+
+template <class T>
+static std::vector<T> parseList(const char* s) {
+    std::vector<T> out;
+    std::stringstream in(s);
+    std::string item;
+    while (std::getline(in, item, ','))
+        if (!item.empty()) out.push_back(T(std::strtoull(item.c_str(), nullptr, 10)));
+    return out;
+}
+
+static std::vector<std::string> parseNames(const char* s) {
+    std::vector<std::string> out;
+    std::stringstream in(s);
+    std::string item;
+    while (std::getline(in, item, ','))
+        if (!item.empty()) out.push_back(item);
+    return out;
+}
+
+// --- Timing ---
+
+struct Result {
+    uint64_t iters         = 0;
+    double   nsPerIter     = 0.0;   // median
+    double   allocsPerIter = 0.0;
+};
+
+// Run `fn` once to warm up, then until minTime has passed (at least 3
+// times); `between` runs untimed after every iteration
+template <class F, class G>
+static Result measure(double minTime, F&& fn, G&& between) {
+    using clock = std::chrono::steady_clock;
+    fn();
+    between();
+
+    std::vector<double> samples;
+    uint64_t allocs = 0;
+    const auto start = clock::now();
+    while (samples.size() < 3 || std::chrono::duration<double>(clock::now() - start).count() < minTime) {
+        const uint64_t a0 = g_allocs.load(std::memory_order_relaxed);
+        const auto t0 = clock::now();
+        fn();
+        const auto t1 = clock::now();
+        allocs += g_allocs.load(std::memory_order_relaxed) - a0;
+        samples.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count());
+        between();
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result r;
+    r.iters         = samples.size();
+    r.nsPerIter     = samples[samples.size() / 2];
+    r.allocsPerIter = double(allocs) / double(samples.size());
+    return r;
+}
+
+// --- Baseline comparison ---
+
+using CaseKey = std::tuple<std::string, size_t, unsigned, std::string>;
+
+static bool field(const std::string& line, const char* key, std::string& value) {
+    std::string k = std::string(key) + "=";
+    size_t at = line.find(k);
+    while (at != std::string::npos && at != 0 && line[at - 1] != ' ') at = line.find(k, at + 1);
+    if (at == std::string::npos) return false;
+    size_t b = at + k.size(), e = line.find(' ', b);
+    value = line.substr(b, e == std::string::npos ? std::string::npos : e - b);
+    return true;
+}
+
+static bool loadBaseline(const std::string& path, std::map<CaseKey, double>& out) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Cannot read baseline " << path << "\n";
+        return false;
+    }
+    std::string line, bench, bodies, threads, simd, ns;
+    while (std::getline(in, line)) {
+        if (line.compare(0, 6, "bench=") != 0) continue;
+        if (field(line, "bench", bench) && field(line, "bodies", bodies) && field(line, "threads", threads) &&
+            field(line, "simd", simd) && field(line, "ns_per_body", ns))
+            out[CaseKey(bench, std::strtoull(bodies.c_str(), nullptr, 10),
+                        unsigned(std::strtoul(threads.c_str(), nullptr, 10)), simd)] = std::strtod(ns.c_str(), nullptr);
+    }
+    return true;
+}
+
+// --- Cases ---
+
+static bool wants(const Options& o, const char* kernel) {
+    return std::find(o.kernels.begin(), o.kernels.end(), kernel) != o.kernels.end();
+}
+
+int main(int argc, char** argv) {
+    Options o;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (a == "--help" || a == "-h") { usage(); return 0; }
+        if (!v) { usage(); return 1; }
+        if      (a == "--bodies")    o.bodies    = parseList<size_t>(v);
+        else if (a == "--threads")   o.threads   = parseList<unsigned>(v);
+        else if (a == "--kernels")   o.kernels   = parseNames(v);
+        else if (a == "--min-time")  o.minTime   = std::strtod(v, nullptr);
+        else if (a == "--baseline")  o.baseline  = v;
+        else if (a == "--tolerance") o.tolerance = std::strtod(v, nullptr);
+        else if (a == "--simd") {
+            if      (!std::strcmp(v, "scalar")) o.simd = int(SimdLevel::Scalar);
+            else if (!std::strcmp(v, "sse2"))   o.simd = int(SimdLevel::SSE2);
+            else if (!std::strcmp(v, "avx2"))   o.simd = int(SimdLevel::AVX2);
+            else { std::cerr << "Unknown SIMD level: " << v << "\n"; return 1; }
+        }
+        else { std::cerr << "Unknown option: " << a << "\n"; usage(); return 1; }
+        ++i;
+    }
+    if (o.threads.empty()) {
+        const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned t = 1; t < hw; t *= 2) o.threads.push_back(t);
+        o.threads.push_back(hw);
+    }
+
+    std::map<CaseKey, double> base;
+    if (!o.baseline.empty() && !loadBaseline(o.baseline, base)) return 1;
+
+    const PhysicsKernels& kernels = o.simd >= 0 ? physicsKernels(SimdLevel(o.simd)) : physicsKernels();
+    int regressions = 0;
+
+    auto report = [&](const char* bench, size_t n, unsigned threads, const Result& r, double pairsPerIter) {
+        const double nsPerBody = r.nsPerIter / double(n);
+        std::printf("bench=%s bodies=%zu threads=%u simd=%s iters=%llu ns_per_iter=%.0f ns_per_body=%.3f "
+                    "pairs_per_sec=%.4g allocs_per_iter=%.2f\n",
+                    bench, n, threads, kernels.name, (unsigned long long)r.iters, r.nsPerIter, nsPerBody,
+                    r.nsPerIter > 0 ? pairsPerIter * 1e9 / r.nsPerIter : 0.0, r.allocsPerIter);
+        auto it = base.find(CaseKey(bench, n, threads, kernels.name));
+        if (it != base.end() && nsPerBody > it->second * (1.0 + o.tolerance)) {
+            std::printf("regression=%s bodies=%zu threads=%u simd=%s base_ns_per_body=%.3f ns_per_body=%.3f ratio=%.3f\n",
+                        bench, n, threads, kernels.name, it->second, nsPerBody, nsPerBody / it->second);
+            ++regressions;
+        }
+        std::fflush(stdout);
+    };
+    auto idle = [] { Profiler::endFrame(); };
+
+    for (size_t n : o.bodies) {
+        if (n == 0) continue;
+        // Constant density: the default headless cloud is 4096 bodies in ±20
+        const float extent = 20.0f * std::cbrt(float(n) / 4096.0f);
+
+        for (unsigned threads : o.threads) {
+            JobSystem  jobs(threads);
+            Simulation sim;
+            PhysicsWorld& world = sim.world();
+            world.setSimdLevel(kernels.level);
+            world.setJobSystem(&jobs);
+            sim.spawnRandom(n, 1, extent, 0.2f, 1.0f);
+
+            const size_t padded = world.paddedSize();
+            const GravityBodies bodies{ world.x(), world.y(), world.z(), world.masses(), n, padded };
+            FloatArray ax(padded), ay(padded), az(padded);
+            const GravityConfig& gcfg = sim.config().physics.gravity;
+            const unsigned tc = jobs.threadCount();
+
+            if (wants(o, "gravity")) {
+                Gravity gravity;
+                Result r = measure(o.minTime, [&] {
+                    gravity.compute(gcfg, kernels, bodies, ax.data(), ay.data(), az.data(), &jobs);
+                }, idle);
+                report("gravity", n, tc, r, 0.0);
+            }
+            if (wants(o, "exact") && n <= EXACT_MAX_BODIES) {
+                Result r = measure(o.minTime, [&] {
+                    Gravity::computeExact(gcfg, kernels, bodies, ax.data(), ay.data(), az.data(), &jobs);
+                }, idle);
+                report("exact", n, tc, r, double(n) * double(n - 1));
+            }
+            if (wants(o, "step")) {
+                Result r = measure(o.minTime, [&] { sim.tick(); }, idle);
+                report("step", n, tc, r, double(world.broadphase().stats().pairTests));
+            }
+
+            // The rest are single-threaded; run them with the first thread count only
+            if (threads != o.threads.front()) continue;
+
+            if (wants(o, "broadphase")) {
+                Broadphase bp;
+                FrameArena frame;
+                Result r = measure(o.minTime, [&] {
+                    frame.reset();
+                    bp.findPairs(world.x(), world.y(), world.z(), world.radii(), n, frame);
+                }, idle);
+                report("broadphase", n, 1, r, double(bp.stats().pairTests));
+            }
+            if (wants(o, "integrate")) {
+                FloatArray x(world.x(), world.x() + padded), y(world.y(), world.y() + padded), z(world.z(), world.z() + padded);
+                FloatArray vx(padded, 0.0f), vy(padded, 0.0f), vz(padded, 0.0f);
+                FloatArray qx(padded, 0.0f), qy(padded, 0.0f), qz(padded, 0.0f), qw(padded, 1.0f);
+                FloatArray wx(padded, 0.1f), wy(padded, 0.2f), wz(padded, 0.3f);
+                const float dt = 1.0f / 480.0f;
+                Result r = measure(o.minTime, [&] {
+                    kernels.integrateLinear(x.data(), y.data(), z.data(), vx.data(), vy.data(), vz.data(),
+                                            ax.data(), ay.data(), az.data(), padded, dt);
+                    kernels.integrateSpin(qx.data(), qy.data(), qz.data(), qw.data(),
+                                          wx.data(), wy.data(), wz.data(), padded, dt);
+                }, idle);
+                report("integrate", n, 1, r, 0.0);
+            }
+            if (wants(o, "sdf")) {
+                // Tori from the first bodies, queried at every body position
+                SceneSDF sdf;
+                const size_t tori = std::min(n, SDF_TORI);
+                sdf.setTori(world.x(), world.y(), world.z(), world.radii(),
+                            world.qx(), world.qy(), world.qz(), world.qw(), tori);
+                FloatArray d(n), gx(n), gy(n), gz(n);
+                Result r = measure(o.minTime, [&] {
+                    sdf.evaluate(world.x(), world.y(), world.z(), n, d.data(), gx.data(), gy.data(), gz.data());
+                }, idle);
+                report("sdf", n, 1, r, double(n) * double(tori));
+            }
+            if (wants(o, "brickmap")) {
+                // Same points as sdf, against the baked base shape only
+                static BrickMap bricks;
+                if (bricks.empty()) bricks.bake(BrickMapConfig{}, SceneSDF::baseDistance);
+                FloatArray d(n), gx(n), gy(n), gz(n);
+                Result r = measure(o.minTime, [&] {
+                    bricks.sample(world.x(), world.y(), world.z(), n, d.data(), gx.data(), gy.data(), gz.data());
+                }, idle);
+                report("brickmap", n, 1, r, 0.0);
+            }
+        }
+    }
+    return regressions ? 2 : 0;
+}
@@ -0,0 +1,124 @@
+// headless.cpp — run the body simulation without SDL or GL
+//
+//   MetharizonHeadless [--bodies N] [--ticks K] [--seed S] [--threads T]
+//                      [--extent E] [--simd scalar|sse2|avx2] [--exact]
+//                      [--trace out.json] [--replay file.mzr [--frame F]]
+//                      [--scene in.mzs] [--save-scene out.mzs]
+//
+// Spawns N bodies procedurally (or loads frame F of a recording made with
+// Metharizon --record), steps K fixed ticks as fast as possible and prints
+// the throughput and a state checksum. A --scene file replaces the
+// procedural spawn, and --save-scene writes the bodies after the last tick.
+// Same arguments, same checksum — regardless of thread count (the SIMD
+// level is part of the result, so pin it with --simd when comparing
+// machines).
+#include <chrono>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include "Recording.hpp"
+#include "SceneFile.hpp"
+#include "Simulation.hpp"
+
+static void usage() {
+    std::cerr << "usage: MetharizonHeadless [--bodies N] [--ticks K] [--seed S] [--threads T]\n"
+                 "                          [--extent E] [--simd scalar|sse2|avx2] [--exact]\n"
+                 "                          [--trace out.json] [--replay file.mzr [--frame F]]\n"
+                 "                          [--scene in.mzs] [--save-scene out.mzs]\n";
+}
+
+int main(int argc, char** argv) {
+    size_t   bodies  = 4096;
+    uint64_t ticks   = 600;
+    uint64_t seed    = 1;
+    unsigned threads = 0;
+    float    extent  = 20.0f;
+    int      simd    = -1;
+    bool     exact   = false;
+    std::string trace, replay, scene, saveTo;
+    uint64_t frame   = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if      (a == "--exact")            { exact = true; continue; }
+        else if (a == "--help" || a == "-h") { usage(); return 0; }
+        if (!v) { usage(); return 1; }
+        if      (a == "--bodies")  bodies  = std::strtoull(v, nullptr, 10);
+        else if (a == "--ticks")   ticks   = std::strtoull(v, nullptr, 10);
+        else if (a == "--seed")    seed    = std::strtoull(v, nullptr, 10);
+        else if (a == "--threads") threads = unsigned(std::strtoul(v, nullptr, 10));
+        else if (a == "--extent")  extent  = std::strtof(v, nullptr);
+        else if (a == "--trace")   trace   = v;
+        else if (a == "--replay")  replay  = v;
+        else if (a == "--frame")   frame   = std::strtoull(v, nullptr, 10);
+        else if (a == "--scene")   scene   = v;
+        else if (a == "--save-scene") saveTo = v;
+        else if (a == "--simd") {
+            if      (!std::strcmp(v, "scalar")) simd = int(SimdLevel::Scalar);
+            else if (!std::strcmp(v, "sse2"))   simd = int(SimdLevel::SSE2);
+            else if (!std::strcmp(v, "avx2"))   simd = int(SimdLevel::AVX2);
+            else { std::cerr << "Unknown SIMD level: " << v << "\n"; return 1; }
+        }
+        else { std::cerr << "Unknown option: " << a << "\n"; usage(); return 1; }
+        ++i;
+    }
+
+    JobSystem  jobs(threads);
+    Simulation sim;
+    sim.config().physics.gravity.exact = exact;
+    sim.world().setJobSystem(&jobs);
+    if (simd >= 0) sim.world().setSimdLevel(SimdLevel(simd));
+    if (!scene.empty()) {
+        auto l0 = std::chrono::steady_clock::now();
+        SceneReader in;
+        if (!in.open(scene)) return 1;
+        if (!sim.world().assign(in.arrays())) { std::cerr << "Scene " << scene << " has invalid ids\n"; return 1; }
+        sim.config().physics.sdfXform = in.sdfXform();
+        std::printf("scene=%s bodies=%zu load_ms=%.3f\n", scene.c_str(), in.size(),
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - l0).count());
+    } else if (replay.empty()) {
+        sim.spawnRandom(bodies, seed, extent, 0.2f, 1.0f);
+    } else {
+        RecordingReader rec;
+        if (!rec.open(replay)) return 1;
+        if (!rec.seek(size_t(frame))) {
+            std::cerr << "Cannot read frame " << frame << " of " << replay << " (" << rec.frameCount() << " frames)\n";
+            return 1;
+        }
+        std::vector<BodyDesc> captured = rec.frame().bodies();
+        sim.world().spawn(captured.data(), captured.size());
+    }
+
+    if (!trace.empty()) Profiler::beginCapture();
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t k = 0; k < ticks; ++k) {
+        sim.tick();
+        Profiler::endFrame();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+
+    double secs = std::chrono::duration<double>(t1 - t0).count();
+    std::printf("bodies=%zu ticks=%" PRIu64 " threads=%u kernels=%s gravity=%s\n",
+                sim.world().size(), ticks, jobs.threadCount(), sim.world().kernels().name,
+                sim.config().physics.gravity.usesExact(sim.world().size()) ? "exact" : "BH");
+    std::printf("seconds=%.3f steps_per_sec=%.2f ms_per_step=%.3f\n",
+                secs, secs > 0 ? ticks / secs : 0.0, ticks ? secs * 1000.0 / ticks : 0.0);
+    std::printf("checksum=%016" PRIx64 "\n", sim.checksum());
+    const FrameArena& scratch = sim.world().frameArena();
+    std::printf("scratch_high_water=%zu scratch_capacity=%zu scratch_heap_blocks=%zu\n",
+                scratch.highWater(), scratch.capacity(), scratch.heapBlocks());
+    for (const ZoneStats& z : Profiler::stats())
+        std::printf("zone=\"%s\" samples=%zu min_ms=%.3f avg_ms=%.3f p99_ms=%.3f\n",
+                    z.name.c_str(), z.samples, z.minMs, z.avgMs, z.p99Ms);
+    if (!trace.empty() && !Profiler::endCapture(trace)) return 1;
+    if (!saveTo.empty() && !saveScene(saveTo, sim.world(), sim.config().physics.sdfXform)) return 1;
+    return 0;
+}
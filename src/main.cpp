@@ -1,6 +1,9 @@
 #define SDL_MAIN_HANDLED
 #include <SDL.h>
+#include <algorithm>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include <vector>
 
 #define GLM_ENABLE_EXPERIMENTAL
@@ -11,21 +14,57 @@
 #include <glm/gtx/vector_query.hpp> // for glm::reflect
 
 #include "Window.hpp"
-#include "Time.hpp"
+#include "FrameClock.hpp"
 #include "Input.hpp"
 #include "Raymarcher.hpp"
+#include "Simulation.hpp"
+#include "JobSystem.hpp"
+#include "Profiler.hpp"
+#include "Recording.hpp"
+#include "SceneFile.hpp"
+#include "SimThread.hpp"
+#include "BrickMap.hpp"
 
-// Stub SDF; replace with your real map() logic
-float cpuSDF(const glm::vec3& p) {
-    return 1e6f;
-}
+int main(int argc, char** argv){
+    // — command line: --record file [--delta] [--quantize] | --replay file,
+    //   --scene file to start from, pacing —
+    std::string recordPath, replayPath, scenePath, saveScenePath = "metharizon_scene.mzs";
+    RecordingOptions recOpt;
+    float fpsLimit = 0.0f;
+    VSync vsync = VSync::On;
+    bool analytic = false;
+    for(int i=1;i<argc;++i){
+        std::string a = argv[i];
+        if     (a=="--record" && i+1<argc) recordPath = argv[++i];
+        else if(a=="--replay" && i+1<argc) replayPath = argv[++i];
+        else if(a=="--delta")              recOpt.flags |= RECORD_DELTA;
+        else if(a=="--quantize")           recOpt.flags |= RECORD_QUANTIZE;
+        else if(a=="--analytic")           analytic = true;
+        else if(a=="--scene" && i+1<argc)  scenePath = argv[++i];
+        else if(a=="--save-scene" && i+1<argc) saveScenePath = argv[++i];
+        else if(a=="--fps" && i+1<argc)    fpsLimit = std::strtof(argv[++i],nullptr);
+        else if(a=="--vsync" && i+1<argc){
+            std::string v = argv[++i];
+            if     (v=="off")      vsync = VSync::Off;
+            else if(v=="on")       vsync = VSync::On;
+            else if(v=="adaptive") vsync = VSync::Adaptive;
+            else { std::cerr << "Unknown vsync mode: " << v << "\n"; return -1; }
+        }
+        else {
+            std::cerr << "usage: Metharizon [--record file.mzr [--delta] [--quantize]] [--replay file.mzr]\n"
+                         "                  [--scene in.mzs] [--save-scene out.mzs]\n"
+                         "                  [--fps N] [--vsync off|on|adaptive] [--analytic]\n";
+            return -1;
+        }
+    }
 
-int main(){
     // — init window & subsystems —
     Window window;
     if(!window.init(1280,720,"Metharizon")) return -1;
     SDL_SetRelativeMouseMode(SDL_TRUE);
-    Time time; time.init();
+    window.setVSync(vsync);
+    FrameClock clock;
+    clock.setTargetFps(fpsLimit);
     Input input;
     Raymarcher rm;
     if(!rm.init()) return -1;
@@ -34,58 +73,143 @@ int main(){
     RaymarchConfig cfg{};
     cfg.maxSteps = 64;
     cfg.epsilon  = 0.001f;
-    cfg.pass     = 0;
+    cfg.preTile  = 8;
+    // Enhanced tracing: relaxed steps, half-pixel cone epsilon, bound clip
+    auto setEnhanced = [&](bool on){
+        cfg.relax       = on ? 1.5f : 1.0f;
+        cfg.coneEpsilon = on ? 0.5f : 0.0f;
+        cfg.boundClip   = on;
+    };
+    setEnhanced(true);
+    rm.dynamicResolution().config().budgetMs = 12.0f;
 
     // — camera & fractal transform —
     glm::vec3 camPos(0,0,3);
     glm::quat viewOri(1,0,0,0);
     const glm::vec3 worldUp(0,1,0);
     const float speed = 20.0f, sens = 0.0025f;
-    int mode = 2;
+    int mode = RENDER_SHADED;
     glm::mat4 fractalXform(1.0f);
 
-    // — dynamic bodies data —
-    std::vector<glm::vec3> positions;
-    std::vector<glm::vec3> velocities;
-    std::vector<float>     radii;
-    std::vector<float>     masses;
-    std::vector<float>     inertias;
-    std::vector<glm::quat> orientations;
-    std::vector<glm::vec3> angVel;
-    std::vector<unsigned>  ids;
-    unsigned nextID = 1;
+    // — dynamic bodies —
+    JobSystem jobs;
+    Simulation sim;
+    PhysicsWorld& world = sim.world();
+    world.setJobSystem(&jobs);
 
     // — physics params —
     const float spawnDist   = 2.0f;
     const float bodyR       = 0.2f;
     const float density     = 1.0f;
-    const float G           = 200.0f;
-    const float softening   = 0.1f;
-    const float restitution = 1.0f;
-    const float mu          = 0.2f;
-    const int   substeps    = 4;
+    uint64_t    bulkSeed    = 1;
+    PhysicsConfig& physCfg = sim.config().physics;
+    physCfg.gravity.G         = 200.0f;
+    physCfg.gravity.softening = 0.1f;
+    physCfg.gravity.theta     = 0.5f;
+    physCfg.restitution       = 1.0f;
+    physCfg.mu                = 0.2f;
+    physCfg.substeps          = 4;
     auto computeMass    =[&](float r){ return density*(4.0f/3.0f)*3.14159265f*r*r*r; };
     auto computeInertia =[&](float m,float r){ return 0.4f * m * r*r; };
 
+    // — start from a saved scene: mapped, then copied array by array —
+    if(!scenePath.empty()){
+        SceneReader scene;
+        if(!scene.open(scenePath)) return -1;
+        if(!world.assign(scene.arrays())){ std::cerr << "Scene " << scenePath << " has invalid ids\n"; return -1; }
+        fractalXform = scene.sdfXform();
+    }
+    physCfg.sdfXform          = fractalXform;
+
+    // — base shape cache: baked once in its object space, shared read-only
+    //   by the sim thread's collisions and the shader (--analytic skips it) —
+    BrickMap brickMap;
+    if(!analytic){
+        BrickMapConfig bmCfg;
+        bmCfg.band = std::max(bmCfg.band, 2.0f*bodyR);
+        bmCfg.hi = glm::vec3(SceneSDF::baseBound() + 0.5f);   // the shape plus a margin
+        bmCfg.lo = -bmCfg.hi;
+        if(brickMap.bake(bmCfg, SceneSDF::baseDistance)){
+            physCfg.sdfCache = &brickMap;
+            rm.setBrickMap(&brickMap);
+        }
+    }
+
+    // — recording / replay: a replay renders captured frames, no simulation —
+    RecordingWriter recorder;
+    if(!recordPath.empty() && !recorder.open(recordPath,recOpt)) return -1;
+    RecordingReader replay;
+    if(!replayPath.empty() && !replay.open(replayPath)) return -1;
+    const bool replaying = !replayPath.empty();
+    size_t replayNext = 0;
+
+    // — simulation thread: from here on `sim` is only touched through events —
+    SimThread simThread(sim);
+    simThread.setRecorder(&recorder);
+    simThread.setScenePath(saveScenePath);
+    if(!replaying) simThread.start();
+    uint64_t seenTick = ~0ull, seenIdsVersion = ~0ull;
+    auto send = [&](SimEvent e){ if(!replaying) simThread.send(e); };
+
     while(window.isOpen()){
+        Profiler::endFrame();   // drains the zones of the previous iteration
+        PROFILE_ZONE("frame");
         window.pollEvents();
         input.update();
 
-        float dt   = time.deltaTime();
-        float dt_s = dt / float(substeps);
+        float dt = clock.tick();
+
+        // — 'V' cycles vsync off → on → adaptive —
+        if(input.wasKeyPressed(SDL_SCANCODE_V))
+            window.setVSync(VSync((int(window.vsync())+1)%3));
 
         // — spawn on 'P' —
         if(input.wasKeyPressed(SDL_SCANCODE_P)) {
-            glm::vec3 p = camPos + (viewOri * glm::vec3(0,0,-1)) * spawnDist;
-            positions  .push_back(p);
-            velocities .push_back(glm::vec3(0.0f));
-            radii      .push_back(bodyR);
-            masses     .push_back(computeMass(bodyR));
-            inertias   .push_back(computeInertia(masses.back(), bodyR));
-            orientations.push_back(glm::quat(1,0,0,0));
-            angVel     .push_back(glm::vec3(0.0f));
-            ids        .push_back(nextID++);
+            SimEvent e; e.type = SimEvent::Type::Spawn;
+            float m = computeMass(bodyR);
+            e.body = { camPos + (viewOri * glm::vec3(0,0,-1)) * spawnDist, bodyR, m, computeInertia(m, bodyR) };
+            send(e);
+        }
+
+        // — 'B' bulk-spawns a seeded cloud of 1024 bodies, 'K' despawns one —
+        if(input.wasKeyPressed(SDL_SCANCODE_B)) {
+            SimEvent e; e.type = SimEvent::Type::SpawnCloud;
+            e.count = 1024; e.seed = bulkSeed++; e.extent = 10.0f; e.body.radius = bodyR; e.density = density;
+            send(e);
         }
+        if(input.wasKeyPressed(SDL_SCANCODE_K)) { SimEvent e; e.type = SimEvent::Type::DespawnFirst; send(e); }
+
+        // — F5 saves the live scene (see --save-scene) —
+        if(input.wasKeyPressed(SDL_SCANCODE_F5)) { SimEvent e; e.type = SimEvent::Type::SaveScene; send(e); }
+
+        // — render mode on '1'/'2'/'3': step heat map, normals, shaded —
+        if(input.wasKeyPressed(SDL_SCANCODE_1)) mode = RENDER_STEPS;
+        if(input.wasKeyPressed(SDL_SCANCODE_2)) mode = RENDER_NORMALS;
+        if(input.wasKeyPressed(SDL_SCANCODE_3)) mode = RENDER_SHADED;
+
+        // — cycle depth pre-pass tile on 'T': 8 → 4 → off —
+        if(input.wasKeyPressed(SDL_SCANCODE_T)) cfg.preTile = cfg.preTile==8 ? 4 : cfg.preTile==4 ? 1 : 8;
+
+        // — toggle temporal reprojection of last frame's hits on 'R' —
+        if(input.wasKeyPressed(SDL_SCANCODE_R)) cfg.reproject = !cfg.reproject;
+
+        // — A/B the march: 'E' toggles enhanced tracing, 'C' step counting —
+        if(input.wasKeyPressed(SDL_SCANCODE_E)) setEnhanced(cfg.relax == 1.0f);
+        if(input.wasKeyPressed(SDL_SCANCODE_C)) cfg.countSteps = !cfg.countSteps;
+
+        // — profiler: F2 dumps zone stats, F3 starts/stops a Chrome trace —
+        if(input.wasKeyPressed(SDL_SCANCODE_F2)){
+            for(const ZoneStats& z : Profiler::stats())
+                std::printf("%-20s n=%4zu  min %7.3f  avg %7.3f  p99 %7.3f ms\n",
+                            z.name.c_str(),z.samples,z.minMs,z.avgMs,z.p99Ms);
+        }
+        if(input.wasKeyPressed(SDL_SCANCODE_F3)){
+            if(Profiler::capturing()) Profiler::endCapture("metharizon_trace.json");
+            else                      Profiler::beginCapture();
+        }
+
+        // — toggle exact all-pairs gravity on 'G' (validation) —
+        if(input.wasKeyPressed(SDL_SCANCODE_G)) { SimEvent e; e.type = SimEvent::Type::ToggleExact; send(e); }
 
         // — camera control —
         int mx,my; input.getMouseDelta(mx,my);
@@ -102,133 +226,66 @@ int main(){
         if(input.isKeyDown(SDL_SCANCODE_LSHIFT)) camPos -= upVec   * speed * dt;
         if(input.wasKeyPressed(SDL_SCANCODE_ESCAPE)) break;
 
-        size_t n = positions.size();
-        for(int step=0; step<substeps; ++step){
-            // 1) Gravity
-            std::vector<glm::vec3> forces(n, glm::vec3(0.0f));
-            for(size_t i=0;i<n;++i){
-                for(size_t j=i+1;j<n;++j){
-                    glm::vec3 d = positions[j]-positions[i];
-                    float dist2 = glm::dot(d,d)+softening*softening;
-                    float invD  = 1.0f/std::sqrt(dist2);
-                    glm::vec3 dir = d * invD;
-                    float mag = G * masses[i] * masses[j] * (invD*invD);
-                    forces[i] +=  mag * dir;
-                    forces[j] -=  mag * dir;
-                }
-            }
-            // 2) Integrate linear
-            for(size_t i=0;i<n;++i){
-                velocities[i] += (forces[i]/masses[i]) * dt_s;
-                positions [i] += velocities[i] * dt_s;
-            }
-            // 3) Sphere–sphere collisions
-            for(size_t i=0;i<n;++i){
-                for(size_t j=i+1;j<n;++j){
-                    glm::vec3 d = positions[j]-positions[i];
-                    float dist2 = glm::dot(d,d);
-                    float Rsum  = radii[i]+radii[j];
-                    if(dist2 < Rsum*Rsum){
-                        float dist = std::sqrt(dist2);
-                        glm::vec3 N = dist>0? d/dist: glm::vec3(1,0,0);
-                        // unstuck
-                        float pen = Rsum - dist;
-                        positions[i] -= 0.5f * pen * N;
-                        positions[j] += 0.5f * pen * N;
-
-                        // relative velocity at contact
-                        glm::vec3 rA =  N * radii[i];
-                        glm::vec3 rB = -N * radii[j];
-                        glm::vec3 vA = velocities[i] + glm::cross(angVel[i],rA);
-                        glm::vec3 vB = velocities[j] + glm::cross(angVel[j],rB);
-                        glm::vec3 relV = vB - vA;
-
-                        // normal impulse
-                        float vn = glm::dot(relV, N);
-                        if(vn < 0.0f){
-                            float invM = 1.0f/masses[i] + 1.0f/masses[j];
-                            float Jn = -(1.0f+restitution)*vn / invM;
-                            glm::vec3 J = Jn * N;
-
-                            velocities[i] -= J * (1.0f/masses[i]);
-                            velocities[j] += J * (1.0f/masses[j]);
-
-                            // contact point on sphere i:
-                            glm::vec3 contact = positions[i] + rA;
-                            glm::vec3 torque = glm::cross(contact - positions[i], -J);
-                            angVel[i] += torque / inertias[i];
-
-                            contact = positions[j] + rB;
-                            torque = glm::cross(contact - positions[j], +J);
-                            angVel[j] += torque / inertias[j];
-
-                            // friction (Coulomb)
-                            glm::vec3 vt = relV - vn*N;
-                            float vt_len = glm::length(vt);
-                            if(vt_len > 1e-4f){
-                                glm::vec3 tdir = vt / vt_len;
-                                float Jt = glm::min(mu * Jn, vt_len * masses[i]);
-                                glm::vec3 Jf = -Jt * tdir;
-                                velocities[i] -= Jf * (1.0f/masses[i]);
-                                velocities[j] += Jf * (1.0f/masses[j]);
-                                // torque from friction
-                                contact = positions[i] + rA;
-                                angVel[i] += glm::cross(contact - positions[i], -Jf) / inertias[i];
-                                contact = positions[j] + rB;
-                                angVel[j] += glm::cross(contact - positions[j], +Jf) / inertias[j];
-                            }
-                        }
-                    }
-                }
-            }
-            // 4) Sphere–SDF collisions (similar torque logic)
-            glm::mat4 invX = glm::inverse(fractalXform);
-            for(size_t i=0;i<n;++i){
-                glm::vec3 lp = glm::vec3(invX * glm::vec4(positions[i],1));
-                float d = cpuSDF(lp);
-                if(d < radii[i]){
-                    const float e=1e-3f;
-                    glm::vec3 N = glm::normalize(glm::vec3(
-                        cpuSDF(lp+glm::vec3(e,0,0)) - cpuSDF(lp-glm::vec3(e,0,0)),
-                        cpuSDF(lp+glm::vec3(0,e,0)) - cpuSDF(lp-glm::vec3(0,e,0)),
-                        cpuSDF(lp+glm::vec3(0,0,e)) - cpuSDF(lp-glm::vec3(0,0,e))
-                    ));
-                    float pen = radii[i] - d;
-                    positions[i] += N * pen;
-
-                    glm::vec3 v0 = velocities[i];
-                    glm::vec3 J = masses[i] * (glm::reflect(v0,N) * restitution - v0);
-                    velocities[i] = v0 + J / masses[i];
-
-                    // contact point:
-                    glm::vec3 contact = positions[i] - N * radii[i];
-                    glm::vec3 torque = glm::cross(contact - positions[i], J);
-                    angVel[i] += torque / inertias[i];
-                }
-            }
-            // 5) Integrate spin
-            for(size_t i=0;i<n;++i){
-                glm::quat wq(0, angVel[i]);
-                glm::quat dq = wq * orientations[i] * (0.5f * dt_s);
-                orientations[i] = glm::normalize(orientations[i] + dq);
-            }
+        if(replaying){
+            // — replay: the recorded camera and bodies replace input and physics —
+            if(!replay.seek(replayNext)) break;
+            ++replayNext;
+            const FrameInput& in = replay.frame().input;
+            camPos  = glm::vec3(in.camPos[0],in.camPos[1],in.camPos[2]);
+            viewOri = glm::quat(in.camOri[3],in.camOri[0],in.camOri[1],in.camOri[2]);
+            mode    = in.mode;
+            forward = viewOri*glm::vec3(0,0,-1);
+            right   = viewOri*glm::vec3(1,0,0);
+            upVec   = viewOri*glm::vec3(0,1,0);
+        } else {
+            // — this frame's input goes to the sim thread (and its recording) —
+            SimEvent e;
+            FrameInput& in = e.input;
+            in.dt = dt; in.mouseDX = mx; in.mouseDY = my; in.mode = mode;
+            const SDL_Scancode keys[6] = { SDL_SCANCODE_W, SDL_SCANCODE_A, SDL_SCANCODE_S,
+                                           SDL_SCANCODE_D, SDL_SCANCODE_SPACE, SDL_SCANCODE_LSHIFT };
+            for(int k=0;k<6;++k) if(input.isKeyDown(keys[k])) in.keys |= 1u<<k;
+            in.camPos[0]=camPos.x;  in.camPos[1]=camPos.y;  in.camPos[2]=camPos.z;
+            in.camOri[0]=viewOri.x; in.camOri[1]=viewOri.y; in.camOri[2]=viewOri.z; in.camOri[3]=viewOri.w;
+            send(e);
+            simThread.acquire();
         }
 
-        // — upload & render —
-        rm.updateSpawns(positions, radii, ids, orientations);
+        // — upload & render: the newest sim snapshot, only what changed since the last one —
+        const SimSnapshot& snap = simThread.snapshot();
+        BodyView bodies = replaying ? replay.frame().view() : snap.view();
+        if(!replaying){
+            if(snap.tick == seenTick && snap.idsVersion == seenIdsVersion) bodies.dirty.clear();
+            if(snap.idsVersion == seenIdsVersion) bodies.idsDirty.clear();
+            seenTick = snap.tick; seenIdsVersion = snap.idsVersion;
+        }
+        size_t n = bodies.count;
+        rm.updateSpawns(bodies);
 
         int W,H; window.getSize(W,H);
         cfg.resolution = {float(W),float(H)};
-        cfg.time       = time.totalTime();
+        cfg.time       = clock.totalTime();
         cfg.camPos     = camPos;
         cfg.camForward = forward;
         cfg.camRight   = right;
         cfg.camUp      = upVec;
 
-        char title[128];
-        float fps = dt>0?1.0f/dt:0.0f, ms=dt*1000.0f;
-        std::snprintf(title,128,"Metharizon | Mode %d | %.1f FPS | %.2f ms | %u objs",
-                      mode,fps,ms,unsigned(n));
+        // — title: frame-time distribution from the clock —
+        char timing[96], steps[48], title[320];
+        static const char* vsyncNames[3] = { "off", "on", "adaptive" };
+        const FrameHistogram& fh = clock.histogram();
+        std::snprintf(timing,96,"%.1f FPS | %.2f p50 / %.2f p99 ms | vsync %s",
+                      fh.avgMs()>0?1000.0f/fh.avgMs():0.0f,fh.percentileMs(0.5f),fh.percentileMs(0.99f),
+                      vsyncNames[int(window.vsync())]);
+        const char* march = cfg.relax>1.0f ? "enhanced" : "plain";
+        if(cfg.countSteps) std::snprintf(steps,48,"%s march %.1f steps",march,rm.averageSteps());
+        else               std::snprintf(steps,48,"%s march",march);
+        const BroadphaseStats& bp = snap.broadphase;
+        const DynamicResolution& dr = rm.dynamicResolution();
+        std::snprintf(title,320,"Metharizon | Mode %d | %s | GPU %.2f ms @ %d%% | %s | sim %.2f ms | %u objs | %s %s x%u | %zu/%zu pair tests",
+                      mode,timing,dr.gpuMs(),int(dr.scale()*100.0f+0.5f),steps,snap.simMs,unsigned(n),
+                      snap.exact?"exact":"BH",snap.kernels,
+                      jobs.threadCount(),bp.pairTests,bp.allPairTests);
         window.setTitle(title);
 
         window.clear();
@@ -236,6 +293,19 @@ int main(){
         window.swapBuffers();
     }
 
-    time.shutdown();
+    simThread.stop();
+
+    // — a finished replay reports where the frame time went —
+    if(replaying){
+        const FrameHistogram& fh = clock.histogram();
+        std::printf("replayed %zu of %zu frames\n",replayNext,replay.frameCount());
+        std::printf("frame_avg_ms=%.3f frame_p50_ms=%.3f frame_p99_ms=%.3f frame_max_ms=%.3f\n",
+                    fh.avgMs(),fh.percentileMs(0.5f),fh.percentileMs(0.99f),fh.maxMs());
+        for(const ZoneStats& z : Profiler::stats())
+            std::printf("zone=\"%s\" samples=%zu min_ms=%.3f avg_ms=%.3f p99_ms=%.3f\n",
+                        z.name.c_str(),z.samples,z.minMs,z.avgMs,z.p99Ms);
+    }
+    if(!recorder.close()) std::cerr << "Recording " << recordPath << " was not closed cleanly\n";
+
     return 0;
 }
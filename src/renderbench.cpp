@@ -0,0 +1,254 @@
+// renderbench.cpp — offscreen render benchmark, no window or display server
+//
+//   MetharizonRenderBench [--width W] [--height H] [--frames N] [--warmup K]
+//                         [--bodies B] [--seed S] [--ticks T] [--path orbit|dolly]
+//                         [--mode steps|normals|shaded] [--scale F] [--pretile N]
+//                         [--plain] [--no-reproject] [--analytic] [--count-steps]
+//                         [--dump DIR [--dump-every N]]
+//
+// Renders a scripted camera path through Raymarcher into an FBO on an EGL
+// context (surfaceless Mesa works, llvmpipe included) and prints key=value
+// lines: one per frame with the CPU submission time and the GPU time from
+// timestamp queries, then a summary. Dynamic resolution is pinned to --scale
+// so runs are comparable. Bodies come from a seeded spawn and stay put unless
+// --ticks advances the simulation between frames. --plain A/B-tests the
+// enhanced march against plain sphere tracing; --count-steps adds the mean
+// march steps per pixel to the summary.
+//
+// --dump writes every N-th frame (default 30) as DIR/frame_NNNNN.ppm for
+// image regression checks; those frames wait on a readback, so they are
+// flagged dumped=1 and left out of the summary.
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <glad/glad.h>
+#include "BrickMap.hpp"
+#include "OffscreenContext.hpp"
+#include "PhysicsWorld.hpp"
+#include "Profiler.hpp"
+#include "Raymarcher.hpp"
+#include "Simulation.hpp"
+
+static void usage() {
+    std::cerr << "usage: MetharizonRenderBench [--width W] [--height H] [--frames N] [--warmup K]\n"
+                 "                             [--bodies B] [--seed S] [--ticks T] [--path orbit|dolly]\n"
+                 "                             [--mode steps|normals|shaded] [--scale F] [--pretile N]\n"
+                 "                             [--plain] [--no-reproject] [--analytic] [--count-steps]\n"
+                 "                             [--dump DIR [--dump-every N]]\n";
+}
+
+// Binary PPM, top row first
+static bool writePPM(const std::string& path, int w, int h, const std::vector<uint8_t>& rgba) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) { std::cerr << "Cannot write " << path << "\n"; return false; }
+    std::fprintf(f, "P6\n%d %d\n255\n", w, h);
+    std::vector<uint8_t> row(size_t(w) * 3);
+    for (int y = h - 1; y >= 0; --y) {
+        const uint8_t* src = rgba.data() + size_t(y) * w * 4;
+        for (int x = 0; x < w; ++x) {
+            row[3*x+0] = src[4*x+0]; row[3*x+1] = src[4*x+1]; row[3*x+2] = src[4*x+2];
+        }
+        std::fwrite(row.data(), 1, row.size(), f);
+    }
+    return std::fclose(f) == 0;
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, size_t(p * double(v.size() - 1) + 0.5))];
+}
+
+static double mean(const std::vector<double>& v) {
+    double s = 0.0;
+    for (double x : v) s += x;
+    return v.empty() ? 0.0 : s / double(v.size());
+}
+
+int main(int argc, char** argv) {
+    int      width = 1280, height = 720;
+    int      frames = 240, warmup = 16;
+    size_t   bodies = 256;
+    uint64_t seed = 1;
+    int      ticks = 0;
+    std::string path = "orbit", dumpDir;
+    int      dumpEvery = 30;
+    int      mode = RENDER_SHADED;
+    float    scale = 1.0f;
+    int      preTile = 8;
+    bool     plain = false, reproject = true, analytic = false, countSteps = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        const char* v = i + 1 < argc ? argv[i + 1] : nullptr;
+        if      (a == "--plain")            { plain = true; continue; }
+        else if (a == "--no-reproject")     { reproject = false; continue; }
+        else if (a == "--analytic")         { analytic = true; continue; }
+        else if (a == "--count-steps")      { countSteps = true; continue; }
+        else if (a == "--help" || a == "-h") { usage(); return 0; }
+        if (!v) { usage(); return 1; }
+        if      (a == "--width")      width     = std::atoi(v);
+        else if (a == "--height")     height    = std::atoi(v);
+        else if (a == "--frames")     frames    = std::atoi(v);
+        else if (a == "--warmup")     warmup    = std::atoi(v);
+        else if (a == "--bodies")     bodies    = std::strtoull(v, nullptr, 10);
+        else if (a == "--seed")       seed      = std::strtoull(v, nullptr, 10);
+        else if (a == "--ticks")      ticks     = std::atoi(v);
+        else if (a == "--path")       path      = v;
+        else if (a == "--scale")      scale     = std::strtof(v, nullptr);
+        else if (a == "--pretile")    preTile   = std::atoi(v);
+        else if (a == "--dump")       dumpDir   = v;
+        else if (a == "--dump-every") dumpEvery = std::max(1, std::atoi(v));
+        else if (a == "--mode") {
+            if      (!std::strcmp(v, "steps"))   mode = RENDER_STEPS;
+            else if (!std::strcmp(v, "normals")) mode = RENDER_NORMALS;
+            else if (!std::strcmp(v, "shaded"))  mode = RENDER_SHADED;
+            else { std::cerr << "Unknown mode: " << v << "\n"; return 1; }
+        }
+        else { std::cerr << "Unknown option: " << a << "\n"; usage(); return 1; }
+        ++i;
+    }
+    if (width <= 0 || height <= 0 || frames <= 0 || (path != "orbit" && path != "dolly")) { usage(); return 1; }
+
+    // --- GL without a window ---
+    OffscreenContext gl;
+    if (!gl.init()) return 1;
+    Raymarcher rm;
+    if (!rm.init()) return 1;
+    DynamicResolutionConfig& dr = rm.dynamicResolution().config();
+    dr.budgetMs = 0.0f;
+    dr.minScale = dr.maxScale = std::clamp(scale, 0.1f, 1.0f);
+
+    GLuint colorTex = 0, fbo = 0;
+    glGenTextures(1, &colorTex);
+    glBindTexture(GL_TEXTURE_2D, colorTex);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glGenFramebuffers(1, &fbo);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, colorTex, 0);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Output framebuffer incomplete\n";
+        return 1;
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    // --- Scene: seeded bodies, the same base-shape cache as the app ---
+    Simulation sim;
+    sim.spawnRandom(bodies, seed, 2.5f, 0.2f, 1.0f);
+    BrickMap brickMap;
+    if (!analytic) {
+        BrickMapConfig bmCfg;
+        bmCfg.band = std::max(bmCfg.band, 0.4f);
+        bmCfg.hi = glm::vec3(SceneSDF::baseBound() + 0.5f);
+        bmCfg.lo = -bmCfg.hi;
+        if (brickMap.bake(bmCfg, SceneSDF::baseDistance)) {
+            sim.config().physics.sdfCache = &brickMap;
+            rm.setBrickMap(&brickMap);
+        }
+    }
+
+    RaymarchConfig cfg{};
+    cfg.resolution  = glm::vec2(float(width), float(height));
+    cfg.maxSteps    = 64;
+    cfg.epsilon     = 0.001f;
+    cfg.preTile     = preTile;
+    cfg.reproject   = reproject;
+    cfg.relax       = plain ? 1.0f : 1.5f;
+    cfg.coneEpsilon = plain ? 0.0f : 0.5f;
+    cfg.boundClip   = !plain;
+    cfg.countSteps  = countSteps;
+    cfg.target      = fbo;
+
+    // --- Frames: warm-up (shader builds, first uploads) is not reported ---
+    const int total = warmup + frames;
+    std::vector<GLuint> queries(size_t(frames) * 2);
+    glGenQueries(GLsizei(queries.size()), queries.data());
+    std::vector<double> cpuMs(size_t(frames), 0.0);
+    std::vector<bool>   dumped(size_t(frames), false);
+    std::vector<uint8_t> pixels;
+    const glm::vec3 worldUp(0, 1, 0);
+    auto wall0 = std::chrono::steady_clock::now();
+
+    for (int f = 0; f < total; ++f) {
+        Profiler::endFrame();
+        const int k = f - warmup;   // reported frame index, < 0 while warming up
+        for (int t = 0; t < ticks; ++t) sim.tick();
+
+        // Camera: orbit the origin once, or dolly in along -z
+        const float u = float(std::max(k, 0)) / float(frames);
+        glm::vec3 camPos;
+        if (path == "orbit") {
+            const float a = 6.2831853f * u;
+            camPos = glm::vec3(3.5f * std::sin(a), 1.0f, 3.5f * std::cos(a));
+        } else {
+            camPos = glm::vec3(0.0f, 0.2f, 5.0f - 3.0f * u);
+        }
+        cfg.camPos     = camPos;
+        cfg.camForward = glm::normalize(-camPos);
+        cfg.camRight   = glm::normalize(glm::cross(cfg.camForward, worldUp));
+        cfg.camUp      = glm::cross(cfg.camRight, cfg.camForward);
+        cfg.time       = float(f) / 60.0f;
+
+        auto t0 = std::chrono::steady_clock::now();
+        if (k >= 0) glQueryCounter(queries[2*k], GL_TIMESTAMP);
+        rm.updateSpawns(sim.world().view());
+        sim.world().clearDirty();
+        rm.render(cfg, mode, glm::mat4(1.0f));
+        if (k >= 0) glQueryCounter(queries[2*k+1], GL_TIMESTAMP);
+        glFlush();
+        auto t1 = std::chrono::steady_clock::now();
+        if (k < 0) { if (k == -1) { glFinish(); wall0 = std::chrono::steady_clock::now(); } continue; }
+        cpuMs[k] = std::chrono::duration<double, std::milli>(t1 - t0).count();
+
+        if (!dumpDir.empty() && k % dumpEvery == 0) {
+            pixels.resize(size_t(width) * height * 4);
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, fbo);
+            glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            glBindFramebuffer(GL_READ_FRAMEBUFFER, 0);
+            char name[32];
+            std::snprintf(name, sizeof name, "/frame_%05d.ppm", k);
+            if (!writePPM(dumpDir + name, width, height, pixels)) return 1;
+            dumped[k] = true;
+        }
+    }
+    glFinish();
+    const double wallSecs = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+
+    // --- Report ---
+    std::vector<double> cpu, gpu;
+    for (int k = 0; k < frames; ++k) {
+        GLuint64 a = 0, b = 0;
+        glGetQueryObjectui64v(queries[2*k],   GL_QUERY_RESULT, &a);
+        glGetQueryObjectui64v(queries[2*k+1], GL_QUERY_RESULT, &b);
+        const double g = b > a ? double(b - a) * 1e-6 : 0.0;
+        std::printf("frame=%d cpu_ms=%.3f gpu_ms=%.3f dumped=%d\n", k, cpuMs[k], g, dumped[k] ? 1 : 0);
+        if (dumped[k]) continue;
+        cpu.push_back(cpuMs[k]);
+        gpu.push_back(g);
+    }
+    glDeleteQueries(GLsizei(queries.size()), queries.data());
+    glDeleteFramebuffers(1, &fbo);
+    glDeleteTextures(1, &colorTex);
+
+    std::printf("renderer=\"%s\" width=%d height=%d scale=%.2f frames=%d bodies=%zu path=%s march=%s\n",
+                gl.renderer(), width, height, dr.maxScale, frames, sim.world().size(), path.c_str(),
+                plain ? "plain" : "enhanced");
+    std::printf("cpu_avg_ms=%.3f cpu_p50_ms=%.3f cpu_p99_ms=%.3f\n",
+                mean(cpu), percentile(cpu, 0.5), percentile(cpu, 0.99));
+    std::printf("gpu_avg_ms=%.3f gpu_p50_ms=%.3f gpu_p99_ms=%.3f\n",
+                mean(gpu), percentile(gpu, 0.5), percentile(gpu, 0.99));
+    if (countSteps) std::printf("avg_steps=%.2f\n", rm.averageSteps());
+    std::printf("scratch_high_water=%zu scratch_capacity=%zu scratch_heap_blocks=%zu\n",
+                rm.frameArena().highWater(), rm.frameArena().capacity(), rm.frameArena().heapBlocks());
+    std::printf("seconds=%.3f frames_per_sec=%.2f\n", wallSecs, wallSecs > 0 ? frames / wallSecs : 0.0);
+    return 0;
+}